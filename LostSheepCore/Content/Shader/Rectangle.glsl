@@ -3,20 +3,35 @@
 layout (location = 0) in vec2 aPosition;
 layout (location = 1) in vec2 aTexCoord;
 
+// Per-instance
+layout (location = 2) in vec3 aQuadPos;
+layout (location = 3) in vec2 aQuadSize;
+layout (location = 4) in vec4 aColor;
+layout (location = 5) in vec2 aQuadParams; // x: corner radius, y: border thickness
+
 out vec2 vTexCoord;
 out vec2 vQuadSize;
+flat out vec4 vColor;
+flat out vec2 vQuadParams;
 
-uniform vec3 uQuadPos;
-uniform vec2 uQuadSize;
-uniform mat4 uViewProjection;
+// Shared by all programs, updated once per frame, layout must match FrameConstants in Shader.h
+layout (std140) uniform FrameConstants
+{
+    mat4 uViewProjection;
+    vec2 uViewportSize;
+    float uTime;
+    float uDpiScale;
+};
 
 void main()
 {
     vTexCoord = aTexCoord;
-    vQuadSize = uQuadSize;
+    vQuadSize = aQuadSize;
+    vColor = aColor;
+    vQuadParams = aQuadParams;
 
-    vec2 worldPosition = uQuadPos.xy + (aPosition * uQuadSize);
-    gl_Position = uViewProjection * vec4(worldPosition, uQuadPos.z, 1.0);
+    vec2 worldPosition = aQuadPos.xy + (aPosition * aQuadSize);
+    gl_Position = uViewProjection * vec4(worldPosition, aQuadPos.z, 1.0);
 }
 
 #shader fragment
@@ -26,10 +41,12 @@ out vec4 FragColor;
 
 in vec2 vTexCoord;
 in vec2 vQuadSize;
+flat in vec4 vColor;
+flat in vec2 vQuadParams;
 
-uniform vec4 uColor;
-uniform float uCornerRadius;
-uniform float uBorderThickness;
+// Permutations, see ShaderFeature in Shader.h
+// LSH_ROUNDED: anti-aliased rounded edges, without it quads cover their whole footprint
+// LSH_BORDER: border ring for quads with a border thickness
 
 float sdRoundedRect(vec2 p, vec2 size, float radius) {
     vec2 d = abs(p) - size + radius;
@@ -38,44 +55,43 @@ float sdRoundedRect(vec2 p, vec2 size, float radius) {
 
 void main()
 {
-    // Convert texture coordinates to pixel coordinates
-    vec2 pixelCoord = vTexCoord * vQuadSize;
+#if defined(LSH_ROUNDED) || defined(LSH_BORDER)
+    // Convert texture coordinates to pixel coordinates, centered on the quad
+    vec2 p = (vTexCoord * vQuadSize) - (vQuadSize * 0.5);
 
-    // Center the coordinate system
-    vec2 center = vQuadSize * 0.5;
-    vec2 p = pixelCoord - center;
-    
     // Rectangle half-size
     vec2 rectSize = vQuadSize * 0.5;
+#endif
+
+#ifdef LSH_ROUNDED
+    float cornerRadius = vQuadParams.x;
 
     // Anti-aliasing factor (smooth edge)
     float smoothFactor = 1.0;
 
-    // Calculate distance to rounded rectangle
-    float dist = sdRoundedRect(p, rectSize, uCornerRadius);
+    float alpha = 1.0 - smoothstep(-smoothFactor, smoothFactor, sdRoundedRect(p, rectSize, cornerRadius));
+#else
+    float alpha = 1.0;
+#endif
 
-    if (uBorderThickness > 0.0f)
+#ifdef LSH_BORDER
+    float borderThickness = vQuadParams.y;
+    if (borderThickness > 0.0f)
     {
-        // With border
-        float outerDist = sdRoundedRect(p, vQuadSize * 0.5 - vec2(uBorderThickness), uCornerRadius);
-        float innerDist = dist;
-        
-        // Outer edge (background to border)r
-        float outerAlpha = 1.0 - smoothstep(-smoothFactor, smoothFactor, outerDist);
-        
-        // Inner edge (border to fill)
-        float innerAlpha = 1.0 - smoothstep(-smoothFactor, smoothFactor, innerDist);
-        
-        // Mix colors
-        vec4 finalColor = mix(vec4(0.0f, 0.0f, 0.0f, 0.0f), uColor, innerAlpha - outerAlpha);
-        
-        FragColor = finalColor;
-    } 
-    else
-    {
-        // Without border
-        float alpha = 1.0 - smoothstep(-smoothFactor, smoothFactor, dist);
-        FragColor = mix(vec4(0.0f, 0.0f, 0.0f, 0.0f), uColor, alpha);
-        //FragColor = vec4(vTexCoord, 0.0f, 1.0f);
+        // Cut out the inside of the border
+#ifdef LSH_ROUNDED
+        float innerDist = sdRoundedRect(p, rectSize - vec2(borderThickness), cornerRadius);
+        alpha -= 1.0 - smoothstep(-smoothFactor, smoothFactor, innerDist);
+#else
+        vec2 outside = step(rectSize - vec2(borderThickness), abs(p));
+        alpha -= 1.0 - max(outside.x, outside.y);
+#endif
     }
+#endif
+
+    FragColor = mix(vec4(0.0f, 0.0f, 0.0f, 0.0f), vColor, alpha);
+
+    // Transparent fragments must not write depth, only opaque square quads are drawn before text that precedes them
+    if (FragColor.a <= 0.0f)
+        discard;
 }
\ No newline at end of file
@@ -3,16 +3,30 @@
 layout (location = 0) in vec2 aPosition;
 layout (location = 1) in vec2 aTexCoord;
 
+// Per-glyph
+layout (location = 2) in vec3 aGlyphPos;
+layout (location = 3) in vec2 aGlyphSize;
+layout (location = 4) in vec4 aAtlasUV; // xy: top-left, zw: bottom-right
+layout (location = 5) in vec4 aColor;
+
 out vec2 vTexCoord;
+flat out vec4 vTextColor;
 
-uniform float uQuadPosZ;
-uniform mat4 uViewProjection;
+layout (std140) uniform FrameConstants
+{
+    mat4 uViewProjection;
+    vec2 uViewportSize;
+    float uTime;
+    float uDpiScale;
+};
 
 void main()
 {
-    vTexCoord = aTexCoord;
+    vTexCoord = mix(aAtlasUV.xy, aAtlasUV.zw, aTexCoord);
+    vTextColor = aColor;
 
-    gl_Position = uViewProjection * vec4(aPosition.xy, uQuadPosZ, 1.0);
+    vec2 worldPosition = aGlyphPos.xy + (aPosition * aGlyphSize);
+    gl_Position = uViewProjection * vec4(worldPosition, aGlyphPos.z, 1.0);
 }
 
 #shader fragment
@@ -21,14 +35,18 @@ void main()
 out vec4 FragColor;
 
 in vec2 vTexCoord;
+flat in vec4 vTextColor;
 
 uniform sampler2D uTexture;
-uniform vec4 uTextColor;
 
 void main()
 {
     vec4 diffuse = vec4(1.0f, 1.0f, 1.0f, texture(uTexture, vTexCoord).r);
 
-    FragColor = uTextColor * diffuse;
+    FragColor = vTextColor * diffuse;
+
+    // Empty texels must not write depth, overlapping glyph boxes of a line share one z and would cut into each other
+    if (FragColor.a <= 0.0f)
+        discard;
     //FragColor = vec4(vTexCoord, 0.0f, 1.0f);
-}
\ No newline at end of file
+}
@@ -3,20 +3,37 @@
 layout (location = 0) in vec2 aPosition;
 layout (location = 1) in vec2 aTexCoord;
 
+// Per-instance
+layout (location = 2) in vec3 aQuadPos;
+layout (location = 3) in vec2 aQuadSize;
+layout (location = 4) in vec4 aColor;
+layout (location = 5) in vec2 aQuadParams; // x: corner radius, y: border thickness
+layout (location = 6) in int aTextureSlot;
+
 out vec2 vTexCoord;
 out vec2 vQuadSize;
+flat out vec4 vColor;
+flat out vec2 vQuadParams;
+flat out int vTextureSlot;
 
-uniform vec3 uQuadPos;
-uniform vec2 uQuadSize;
-uniform mat4 uViewProjection;
+layout (std140) uniform FrameConstants
+{
+    mat4 uViewProjection;
+    vec2 uViewportSize;
+    float uTime;
+    float uDpiScale;
+};
 
 void main()
 {
     vTexCoord = aTexCoord;
-    vQuadSize = uQuadSize;
+    vQuadSize = aQuadSize;
+    vColor = aColor;
+    vQuadParams = aQuadParams;
+    vTextureSlot = aTextureSlot;
 
-    vec2 worldPosition = uQuadPos.xy + (aPosition * uQuadSize);
-    gl_Position = uViewProjection * vec4(worldPosition, uQuadPos.z, 1.0);
+    vec2 worldPosition = aQuadPos.xy + (aPosition * aQuadSize);
+    gl_Position = uViewProjection * vec4(worldPosition, aQuadPos.z, 1.0);
 }
 
 #shader fragment
@@ -26,36 +43,80 @@ out vec4 FragColor;
 
 in vec2 vTexCoord;
 in vec2 vQuadSize;
+flat in vec4 vColor;
+flat in vec2 vQuadParams;
+flat in int vTextureSlot;
 
-uniform sampler2D uTexture;
-uniform float uCornerRadius;
+// Size must match LSH_QUAD_BATCH_MAX_TEXTURES
+uniform sampler2D uTextures[8];
 
+// Same permutations as Rectangle.glsl
 float sdRoundedRect(vec2 p, vec2 size, float radius) {
     vec2 d = abs(p) - size + radius;
     return length(max(d, 0.0f)) + min(max(d.x, d.y), 0.0f) - radius;
 }
 
+// GLSL 330 only allows constant indices into sampler arrays
+vec4 SampleTexture(int slot, vec2 texCoord)
+{
+    switch (slot)
+    {
+    case 0: return texture(uTextures[0], texCoord);
+    case 1: return texture(uTextures[1], texCoord);
+    case 2: return texture(uTextures[2], texCoord);
+    case 3: return texture(uTextures[3], texCoord);
+    case 4: return texture(uTextures[4], texCoord);
+    case 5: return texture(uTextures[5], texCoord);
+    case 6: return texture(uTextures[6], texCoord);
+    case 7: return texture(uTextures[7], texCoord);
+    }
+    return vec4(1.0f);
+}
+
 void main()
 {
-    // Convert texture coordinates to pixel coordinates
-    vec2 pixelCoord = vTexCoord * vQuadSize;
+#if defined(LSH_ROUNDED) || defined(LSH_BORDER)
+    // Convert texture coordinates to pixel coordinates, centered on the quad
+    vec2 p = (vTexCoord * vQuadSize) - (vQuadSize * 0.5);
 
-    // Center the coordinate system
-    vec2 center = vQuadSize * 0.5;
-    vec2 p = pixelCoord - center;
-    
     // Rectangle half-size
     vec2 rectSize = vQuadSize * 0.5;
+#endif
+
+    // Untextured quads share the batch with images
+    vec4 diffuse = vColor;
+    if (vTextureSlot >= 0)
+        diffuse *= SampleTexture(vTextureSlot, vTexCoord);
+
+#ifdef LSH_ROUNDED
+    float cornerRadius = vQuadParams.x;
 
     // Anti-aliasing factor (smooth edge)
     float smoothFactor = 1.0;
 
-    // Calculate distance to rounded rectangle
-    float dist = sdRoundedRect(p, rectSize, uCornerRadius);
+    float alpha = 1.0 - smoothstep(-smoothFactor, smoothFactor, sdRoundedRect(p, rectSize, cornerRadius));
+#else
+    float alpha = 1.0;
+#endif
 
-    vec4 diffuse = texture(uTexture, vTexCoord);
+#ifdef LSH_BORDER
+    float borderThickness = vQuadParams.y;
+    if (borderThickness > 0.0f)
+    {
+#ifdef LSH_ROUNDED
+        float innerDist = sdRoundedRect(p, rectSize - vec2(borderThickness), cornerRadius);
+        alpha -= 1.0 - smoothstep(-smoothFactor, smoothFactor, innerDist);
+#else
+        vec2 outside = step(rectSize - vec2(borderThickness), abs(p));
+        alpha -= 1.0 - max(outside.x, outside.y);
+#endif
+    }
+#endif
 
-    float alpha = 1.0 - smoothstep(-smoothFactor, smoothFactor, dist);
     FragColor = mix(vec4(0.0f, 0.0f, 0.0f, 0.0f), diffuse, alpha);
+
+    // Transparent fragments must not write depth, only opaque square quads are drawn before text that precedes them
+    if (FragColor.a <= 0.0f)
+        discard;
     //FragColor = vec4(vTexCoord, 0.0f, 1.0f);
 }
\ No newline at end of file
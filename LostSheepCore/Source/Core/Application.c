@@ -1,21 +1,66 @@
 #include "Application.h"
 
+#include "Core/Atomic.h"
+#include "Core/Clock.h"
+#include "Core/FrameArena.h"
+#include "Core/FramePacer.h"
+#include "Core/FrameTimings.h"
+#include "Core/Input.h"
+#include "Core/JobSystem.h"
 #include "Core/Window.h"
 #include "Core/Log.h"
+#include "Core/Memory.h"
+#include "Core/Profiler.h"
+#include "Core/Thread.h"
 
 #include "Event/Event.h"
+#include "Event/EventRecorder.h"
 
 #include "Renderer/Renderer.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 
-static int s_Running = 1;
+// Written by whichever thread handles the close event, read by both in render thread mode
+static volatile uint32_t s_Running = 1;
 
-static float s_LastFrameTime = 0.0f;
+static int s_UseRenderThread = 0;
+static Thread s_RenderThread;
+
+// Idle frames sleep until input or this timeout in seconds, so timers still get to run
+static double s_IdleWaitTimeout = 0.5;
+
+static const char* s_RecordPath = NULL;
+static const char* s_ReplayPath = NULL;
+static const char* s_ProfilePath = NULL;
+static int s_ReplayFixedRate = 0;
+
+// Delta time in milliseconds of a fixed rate replay frame
+static float s_ReplayFixedDeltaTime = 1000.0f / 60.0f;
+
+static FramePacingMode s_PacingMode = FramePacingMode_VSync;
+static float s_TargetFramesPerSecond = 0.0f;
+
+static FrameLatencyStats s_LatencyStats;
 
 int InitApplication(const char* title, int width, int height)
 {
+	InitLog();
 	LSH_INFO("Lost Sheep");
+
+	// Started first so loading shows up in the trace
+	SetProfileThreadName("Main");
+	if (s_ProfilePath != NULL)
+		BeginProfileSession(s_ProfilePath);
+
+	// The recording decides the window size so layouts match
+	if (s_ReplayPath != NULL)
+	{
+		if (!LoadEventReplay(s_ReplayPath))
+			return 0;
+		GetEventReplayWindowSize(&width, &height);
+	}
+
     if (!CreateWindow(title, width, height))
     {
         LSH_FATAL("Can't create application! Window creation failed...");
@@ -24,6 +69,40 @@ int InitApplication(const char* title, int width, int height)
     }
 
 	SetWindowEventCallback(OnEventApplication);
+	InitInput();
+
+	if (!InitFrameArena(LSH_FRAME_ARENA_CAPACITY))
+		return 0;
+
+	if (!InitJobSystem(0))
+		return 0;
+
+	// Fixed rate replays measure the work per frame, not the display
+	if (IsReplayingEvents() && s_ReplayFixedRate)
+		InitFramePacer(FramePacingMode_Unlimited, 0.0f);
+	else
+		InitFramePacer(s_PacingMode, s_TargetFramesPerSecond);
+
+	if (IsReplayingEvents())
+	{
+		HideWindow();
+	}
+	else if (s_RecordPath != NULL)
+	{
+		const WindowData* data = GetWindowData();
+		double startTime = GetTimestampWindow();
+		if (BeginEventRecording(s_RecordPath, data->Width, data->Height, startTime))
+		{
+			// Replays start from the same cursor position
+			Event event;
+			InitEvent(&event, EventTypeMouseMoved, sizeof(MousePositionPayload));
+			event.Timestamp = startTime;
+			GetMousePosition(&event.Payload.MousePosition.X, &event.Payload.MousePosition.Y);
+			RecordEvent(&event);
+		}
+	}
+
+	SubscribeEvent(EventTypeWindowClose, OnEventWindowClose, EventPriorityApplication);
 
 	LSH_TRACE("Application created");
     
@@ -32,35 +111,269 @@ int InitApplication(const char* title, int width, int height)
     return 1;
 }
 
-void RunApplication()
+// Present time is when the swap returns, the display may show the frame later
+static void RecordFrameLatency(double presentTime)
 {
-    while (s_Running)
-	{
-		float deltaTime = GetTimeWindow();
-		deltaTime -= s_LastFrameTime;
-        s_LastFrameTime = GetTimeWindow();
+	double inputTime = GetInputFrameTimestamp();
+	if (inputTime == 0.0)
+		return;
 
-        deltaTime *= 1000.f;
+	float latency = (float)((presentTime - inputTime) * 1000.0);
 
-		BeginRendering();
-        OnUpdateRenderer(deltaTime);
-        EndRendering();
+	s_LatencyStats.Frames++;
+	s_LatencyStats.Last = latency;
+	s_LatencyStats.Average += (latency - s_LatencyStats.Average) / (float)s_LatencyStats.Frames;
+	if (latency > s_LatencyStats.Max)
+		s_LatencyStats.Max = latency;
+}
+
+// Samples the polled input, lays out and presents, returns whether a frame was presented
+static int UpdateFrame(float deltaTime)
+{
+	BeginInputFrame();
+	ProcessEventsWindow();
 
+	// Nothing to present when the UI didn't change
+	int presented = OnUpdateRenderer(deltaTime);
+	if (presented)
+	{
+		BeginFrameTimingZone(FrameTimingZone_Swap);
 		OnUpdateWindow(deltaTime);
+		EndFrameTimingZone(FrameTimingZone_Swap);
+
+		RecordFrameLatency(GetTimestampWindow());
+		EndFrameTimings();
+	}
+
+	return presented;
+}
+
+// Run by the window while a modal resize or move keeps PollEventsWindow from returning
+static void RunModalFrame()
+{
+	float deltaTime = BeginFramePacer();
+
+	LSH_PROFILE_BEGIN("ModalFrame");
+	BeginFrameTimings();
+
+	int presented = UpdateFrame(deltaTime);
+
+	LSH_PROFILE_END();
+
+	EndFramePacer(presented);
+	EndEventRecordingFrame();
+}
+
+static void RunFrameLoop()
+{
+    while (AtomicLoad32(&s_Running))
+	{
+		// Capped pacing waits here, before input is sampled, so the wait doesn't add to input latency
+		float deltaTime = BeginFramePacer();
+
+		LSH_PROFILE_BEGIN("Frame");
+		BeginFrameTimings();
+
+		// Input is polled and sampled as late as possible, right before the layout
+		PollEventsWindow();
+		int presented = UpdateFrame(deltaTime);
+
+		LSH_PROFILE_END();
+
+		EndFramePacer(presented);
+
+		if (!presented)
+			WaitEventsWindow(s_IdleWaitTimeout);
+
+		EndEventRecordingFrame();
 
 		//LSH_TRACE("Frame Time: %.3f ms (%.1f FPS)", deltaTime, 1000.0f / deltaTime);
     }
 }
 
+static void OnReplayEventApplication(Event* event)
+{
+	// Hidden window follows the recorded size, the live resize it causes is dropped
+	if (event->Type == EventTypeWindowResize)
+		SetSizeWindow(event->Payload.WindowSize.Width, event->Payload.WindowSize.Height);
+
+	PublishEvent(event);
+}
+
+static void RunReplayLoop()
+{
+	char timingPath[512];
+	snprintf(timingPath, sizeof(timingPath), "%s.timing.csv", s_ReplayPath);
+	FILE* timing = fopen(timingPath, "w");
+	if (timing != NULL)
+		fprintf(timing, "frame,events,presented,delta_ms,cpu_ms\n");
+	else
+		LSH_WARN("Failed to open %s, frame times are not written", timingPath);
+
+	uint32_t frameCount = 0;
+	uint32_t presentedCount = 0;
+	double totalCpuTime = 0.0;
+	double maxCpuTime = 0.0;
+
+	double startTime = GetTimestampWindow();
+
+	while (AtomicLoad32(&s_Running))
+	{
+		float deltaTime = BeginFramePacer();
+		if (s_ReplayFixedRate)
+			deltaTime = s_ReplayFixedDeltaTime;
+
+		uint64_t frameStart = GetTicksClock();
+		BeginFrameTimings();
+
+		// Live events only matter for closing, OnEventApplication drops the rest
+		PollEventsWindow();
+		BeginInputFrame();
+		ProcessEventsWindow();
+
+		int eventCount = ReplayEventsFrame(s_ReplayFixedRate, GetTimestampWindow() - startTime, OnReplayEventApplication);
+		if (eventCount < 0)
+			break;
+
+		int presented = OnUpdateRenderer(deltaTime);
+		if (presented)
+		{
+			BeginFrameTimingZone(FrameTimingZone_Swap);
+			OnUpdateWindow(deltaTime);
+			EndFrameTimingZone(FrameTimingZone_Swap);
+			EndFrameTimings();
+		}
+
+		EndFramePacer(presented);
+
+		double cpuTime = TicksToMillisecondsClock(GetTicksClock() - frameStart);
+
+		if (timing != NULL)
+			fprintf(timing, "%u,%d,%d,%.3f,%.3f\n", frameCount, eventCount, presented, deltaTime, cpuTime);
+
+		frameCount++;
+		presentedCount += presented;
+		totalCpuTime += cpuTime;
+		if (cpuTime > maxCpuTime)
+			maxCpuTime = cpuTime;
+
+		// Real time replays idle like a live session until the next recorded event is due
+		if (!presented && !s_ReplayFixedRate)
+		{
+			double wait = GetNextEventReplayTime() - (GetTimestampWindow() - startTime);
+			if (wait > 0.0)
+				WaitEventsWindow(wait < s_IdleWaitTimeout ? wait : s_IdleWaitTimeout);
+		}
+	}
+
+	if (timing != NULL)
+		fclose(timing);
+
+	LSH_INFO("Replay finished: %u frames, %u presented, cpu avg %.3f ms, max %.3f ms",
+		frameCount, presentedCount, frameCount > 0 ? totalCpuTime / frameCount : 0.0, maxCpuTime);
+}
+
+static void RenderThreadMain(void* userData)
+{
+	SetProfileThreadName("Render");
+	MakeContextCurrentWindow();
+
+	RunFrameLoop();
+
+	ReleaseContextWindow();
+
+	// The main thread may be blocked waiting for events
+	WakeWindow();
+}
+
+void EnableRenderThreadApplication(int enable)
+{
+	s_UseRenderThread = enable;
+}
+
+void SetFramePacingApplication(FramePacingMode mode, float targetFramesPerSecond)
+{
+	s_PacingMode = mode;
+	s_TargetFramesPerSecond = targetFramesPerSecond;
+}
+
+const FrameLatencyStats* GetFrameLatencyStatsApplication()
+{
+	return &s_LatencyStats;
+}
+
+void ProfileApplication(const char* path)
+{
+	s_ProfilePath = path;
+}
+
+void RecordEventsApplication(const char* path)
+{
+	s_RecordPath = path;
+}
+
+void ReplayEventsApplication(const char* path, int fixedRate)
+{
+	s_ReplayPath = path;
+	s_ReplayFixedRate = fixedRate;
+}
+
+void RunApplication()
+{
+	LSH_PROFILE_BEGIN("RunApplication");
+
+	if (IsReplayingEvents())
+	{
+		if (s_UseRenderThread)
+			LSH_WARN("Event replay runs on a single thread, ignoring the render thread");
+
+		RunReplayLoop();
+		LSH_PROFILE_END();
+		return;
+	}
+
+	// The render thread keeps presenting during a modal resize or move on its own
+	SetWindowModalFrameCallback(RunModalFrame);
+
+	if (!s_UseRenderThread || !BeginThreadedWindow())
+	{
+		RunFrameLoop();
+		LSH_PROFILE_END();
+		return;
+	}
+
+	if (!StartThread(&s_RenderThread, RenderThreadMain, NULL))
+	{
+		EndThreadedWindow();
+		RunFrameLoop();
+		LSH_PROFILE_END();
+		return;
+	}
+
+	LSH_TRACE("Render thread started");
+
+	// Polling stays responsive no matter how long a frame takes
+	while (AtomicLoad32(&s_Running))
+		PumpEventsWindow();
+
+	JoinThread(&s_RenderThread);
+	EndThreadedWindow();
+
+	LSH_TRACE("Render thread joined");
+
+	LSH_PROFILE_END();
+}
+
 void OnEventApplication(Event* event)
 {    
 	//WindowLogEvent(event);
 
-	DispatchEvent(EventTypeWindowClose, event, OnEventWindowClose);
+	if (IsReplayingEvents() && event->Type != EventTypeWindowClose)
+		return;
 
-	OnEventRenderer(event);
+	RecordEvent(event);
 
-    free(event->Data);
+	PublishEvent(event);
 }
 
 int OnEventWindowClose(Event* event)
@@ -72,11 +385,32 @@ int OnEventWindowClose(Event* event)
 void CloseApplication()
 {
     LSH_INFO("Close window event: %s", GetWindowData()->Title);
-    s_Running = 0;
+    AtomicStore32(&s_Running, 0);
 }
 
 void ShutdownApplication()
 {
     ShutdownRenderer();
+	ShutdownFrameArena();
+	ShutdownJobSystem();
+	UnsubscribeEvent(EventTypeWindowClose, OnEventWindowClose);
+	ShutdownInput();
+
+	// Worker and render threads are joined, every buffer is final
+	ShutdownProfiler();
+
+	if (s_LatencyStats.Frames > 0)
+		LSH_INFO("Input to present latency: avg %.2f ms, max %.2f ms over %u frames", s_LatencyStats.Average, s_LatencyStats.Max, s_LatencyStats.Frames);
+
+	const FramePacerStats* pacing = GetFramePacerStats();
+	if (pacing->SampleCount > 0)
+		LSH_INFO("Frame time: avg %.2f ms, min %.2f ms, max %.2f ms, jitter %.2f ms", pacing->AverageFrameTime, pacing->MinFrameTime, pacing->MaxFrameTime, pacing->Jitter);
+
+	EndEventRecording();
+	UnloadEventReplay();
     LSH_INFO("Application shut down");
+
+	// Everything is released by now, the writer thread was the last one running
+	ShutdownLog();
+	ReportMemoryLeaks();
 }
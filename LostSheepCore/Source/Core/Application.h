@@ -1,9 +1,41 @@
 #pragma once
 
+#include "Core/FramePacer.h"
+
+#include <stdint.h>
+
 typedef struct Event Event;
 
+// Time from the oldest input event of a presented frame until its swap returned, in milliseconds
+typedef struct FrameLatencyStats
+{
+	float Last;
+	float Average;
+	float Max;
+	uint32_t Frames; // Presented frames that carried input
+} FrameLatencyStats;
+
 int InitApplication(const char* title, int width, int height);
 
+// Runs polling on the calling thread and layout and rendering on a separate thread, call before RunApplication
+void EnableRenderThreadApplication(int enable);
+
+// Call before InitApplication, the target is only used by the capped mode
+void SetFramePacingApplication(FramePacingMode mode, float targetFramesPerSecond);
+
+const FrameLatencyStats* GetFrameLatencyStatsApplication();
+
+// Writes a Chrome trace of the whole run to path, started before anything is loaded
+void ProfileApplication(const char* path);
+
+// Writes every dispatched event to path, call before InitApplication
+void RecordEventsApplication(const char* path);
+
+// Drives the application from a recording instead of live input, call before InitApplication.
+// Fixed rate replays one recorded frame per frame with a constant delta time and no vsync,
+// otherwise events are replayed at the pace they were recorded. Frame times go to <path>.timing.csv
+void ReplayEventsApplication(const char* path, int fixedRate);
+
 void RunApplication();
 
 void OnEventApplication(Event* event);
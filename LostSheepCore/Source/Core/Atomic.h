@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+// Acquire loads, release stores and full-barrier read-modify-writes on 32-bit values
+
+#if defined(_MSC_VER)
+
+#include <intrin.h>
+
+// Aligned loads and stores are atomic on x64 and only need to be kept from being reordered by the compiler
+static inline uint32_t AtomicLoad32(volatile uint32_t* value)
+{
+	uint32_t result = *value;
+	_ReadWriteBarrier();
+	return result;
+}
+
+static inline void AtomicStore32(volatile uint32_t* value, uint32_t desired)
+{
+	_ReadWriteBarrier();
+	*value = desired;
+}
+
+// Returns the previous value
+static inline uint32_t AtomicAdd32(volatile uint32_t* value, uint32_t amount)
+{
+	return (uint32_t)_InterlockedExchangeAdd((volatile long*)value, (long)amount);
+}
+
+// Returns 1 if the value was swapped
+static inline int AtomicCompareExchange32(volatile uint32_t* value, uint32_t expected, uint32_t desired)
+{
+	return (uint32_t)_InterlockedCompareExchange((volatile long*)value, (long)desired, (long)expected) == expected;
+}
+
+// Full barrier, keeps a store from being reordered with a later load
+static inline void AtomicFence()
+{
+	_mm_mfence();
+}
+
+#else
+
+static inline uint32_t AtomicLoad32(volatile uint32_t* value)
+{
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void AtomicStore32(volatile uint32_t* value, uint32_t desired)
+{
+	__atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+// Returns the previous value
+static inline uint32_t AtomicAdd32(volatile uint32_t* value, uint32_t amount)
+{
+	return __atomic_fetch_add(value, amount, __ATOMIC_SEQ_CST);
+}
+
+// Returns 1 if the value was swapped
+static inline int AtomicCompareExchange32(volatile uint32_t* value, uint32_t expected, uint32_t desired)
+{
+	return __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+// Full barrier, keeps a store from being reordered with a later load
+static inline void AtomicFence()
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include "Channel.h"
+
+#include "Core/Atomic.h"
+#include "Core/Log.h"
+#include "Core/Memory.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int InitChannel(Channel* channel, uint32_t elementSize, uint32_t capacity)
+{
+	uint32_t roundedCapacity = 1;
+	while (roundedCapacity < capacity)
+		roundedCapacity <<= 1;
+
+	channel->Buffer = (unsigned char*)LSH_MALLOC((size_t)elementSize * roundedCapacity, MemoryTag_Event);
+	if (channel->Buffer == NULL)
+	{
+		LSH_FATAL("Failed to allocate memory for Channel");
+		return 0;
+	}
+
+	channel->ElementSize = elementSize;
+	channel->Capacity = roundedCapacity;
+	channel->Head = 0;
+	channel->Tail = 0;
+
+	return 1;
+}
+
+int TryPushChannel(Channel* channel, const void* element)
+{
+	// Indices run freely and wrap on overflow, only their difference matters
+	uint32_t head = channel->Head;
+	uint32_t tail = AtomicLoad32(&channel->Tail);
+	if (head - tail >= channel->Capacity)
+		return 0;
+
+	memcpy(channel->Buffer + (size_t)(head & (channel->Capacity - 1)) * channel->ElementSize, element, channel->ElementSize);
+
+	// Publishes the element to the consumer
+	AtomicStore32(&channel->Head, head + 1);
+	return 1;
+}
+
+int TryPopChannel(Channel* channel, void* element)
+{
+	uint32_t tail = channel->Tail;
+	uint32_t head = AtomicLoad32(&channel->Head);
+	if (head == tail)
+		return 0;
+
+	memcpy(element, channel->Buffer + (size_t)(tail & (channel->Capacity - 1)) * channel->ElementSize, channel->ElementSize);
+
+	// Hands the slot back to the producer
+	AtomicStore32(&channel->Tail, tail + 1);
+	return 1;
+}
+
+int IsChannelEmpty(Channel* channel)
+{
+	return AtomicLoad32(&channel->Head) == AtomicLoad32(&channel->Tail);
+}
+
+void ShutdownChannel(Channel* channel)
+{
+	LSH_FREE(channel->Buffer);
+	channel->Buffer = NULL;
+	channel->Capacity = 0;
+}
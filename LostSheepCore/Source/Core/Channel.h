@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+// Keeps the producer and consumer indices on separate cache lines
+#define LSH_CACHE_LINE_SIZE 64
+
+// Lock-free ring buffer for exactly one producer thread and one consumer thread
+typedef struct Channel
+{
+	unsigned char* Buffer;
+	uint32_t ElementSize;
+	uint32_t Capacity; // Power of two
+
+	// Written by the producer only
+	volatile uint32_t Head;
+	char HeadPadding[LSH_CACHE_LINE_SIZE - sizeof(uint32_t)];
+
+	// Written by the consumer only
+	volatile uint32_t Tail;
+	char TailPadding[LSH_CACHE_LINE_SIZE - sizeof(uint32_t)];
+} Channel;
+
+// Capacity is rounded up to a power of two
+int InitChannel(Channel* channel, uint32_t elementSize, uint32_t capacity);
+
+// Returns 0 if the channel is full
+int TryPushChannel(Channel* channel, const void* element);
+
+// Returns 0 if the channel is empty
+int TryPopChannel(Channel* channel, void* element);
+
+int IsChannelEmpty(Channel* channel);
+
+void ShutdownChannel(Channel* channel);
@@ -0,0 +1,24 @@
+#include "Clock.h"
+
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+
+uint64_t GetTicksClock()
+{
+	return (uint64_t)glfwGetTimerValue();
+}
+
+uint64_t GetFrequencyClock()
+{
+	return (uint64_t)glfwGetTimerFrequency();
+}
+
+double TicksToMillisecondsClock(uint64_t ticks)
+{
+	return (double)ticks * 1000.0 / (double)glfwGetTimerFrequency();
+}
+
+uint64_t MillisecondsToTicksClock(double milliseconds)
+{
+	return (uint64_t)(milliseconds * (double)glfwGetTimerFrequency() / 1000.0);
+}
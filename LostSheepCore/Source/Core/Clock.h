@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+
+// Monotonic 64-bit tick counter, safe from any thread
+uint64_t GetTicksClock();
+
+uint64_t GetFrequencyClock();
+
+double TicksToMillisecondsClock(uint64_t ticks);
+
+uint64_t MillisecondsToTicksClock(double milliseconds);
@@ -0,0 +1,194 @@
+#include "FrameArena.h"
+
+#include "Core/Log.h"
+#include "Core/Memory.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct FrameArenaBlock
+{
+	struct FrameArenaBlock* Next;
+	size_t Capacity;
+	size_t Used;
+} FrameArenaBlock;
+
+typedef struct FrameArenaBuffer
+{
+	FrameArenaBlock* First;
+	FrameArenaBlock* Current;
+	size_t Used;
+	uint32_t Allocations;
+} FrameArenaBuffer;
+
+static FrameArenaBuffer s_Buffers[2];
+static uint32_t s_CurrentBuffer = 0;
+static size_t s_BlockCapacity = LSH_FRAME_ARENA_CAPACITY;
+
+static FrameArenaStats s_Stats;
+
+// Block memory starts right after the header
+static unsigned char* GetBlockData(FrameArenaBlock* block)
+{
+	return (unsigned char*)(block + 1);
+}
+
+static FrameArenaBlock* CreateBlock(size_t capacity)
+{
+	FrameArenaBlock* block = (FrameArenaBlock*)LSH_MALLOC(sizeof(FrameArenaBlock) + capacity, MemoryTag_Core);
+	if (block == NULL)
+		return NULL;
+
+	block->Next = NULL;
+	block->Capacity = capacity;
+	block->Used = 0;
+
+	s_Stats.Capacity += capacity;
+
+	return block;
+}
+
+// Returns the aligned offset into the block or capacity + 1 if it doesn't fit
+static size_t FitInBlock(FrameArenaBlock* block, size_t size, size_t alignment)
+{
+	uintptr_t address = (uintptr_t)(GetBlockData(block) + block->Used);
+	uintptr_t aligned = (address + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+	size_t offset = block->Used + (size_t)(aligned - address);
+
+	if (offset + size > block->Capacity)
+		return block->Capacity + 1;
+
+	return offset;
+}
+
+int InitFrameArena(size_t capacity)
+{
+	s_BlockCapacity = capacity;
+
+	for (int i = 0; i < 2; i++)
+	{
+		s_Buffers[i].First = CreateBlock(capacity);
+		if (s_Buffers[i].First == NULL)
+		{
+			LSH_FATAL("Failed to allocate memory for frame arena");
+			return 0;
+		}
+
+		s_Buffers[i].Current = s_Buffers[i].First;
+		s_Buffers[i].Used = 0;
+		s_Buffers[i].Allocations = 0;
+	}
+
+	s_CurrentBuffer = 0;
+
+	LSH_TRACE("Frame arena initialized: 2x%zu KB", capacity / 1024);
+
+	return 1;
+}
+
+void BeginFrameArena()
+{
+	s_CurrentBuffer ^= 1;
+	FrameArenaBuffer* buffer = &s_Buffers[s_CurrentBuffer];
+
+	// What the buffer took since its last reset is one frame worth of allocations
+	s_Stats.LastFrameUsed = buffer->Used;
+	s_Stats.LastFrameAllocations = buffer->Allocations;
+	if (buffer->Used > s_Stats.HighWaterMark)
+		s_Stats.HighWaterMark = buffer->Used;
+
+	// Overflow blocks are kept, a frame that needed them once likely needs them again
+	for (FrameArenaBlock* block = buffer->First; block != NULL; block = block->Next)
+		block->Used = 0;
+
+	buffer->Current = buffer->First;
+	buffer->Used = 0;
+	buffer->Allocations = 0;
+}
+
+void* AllocateFrameArena(size_t size, size_t alignment)
+{
+	FrameArenaBuffer* buffer = &s_Buffers[s_CurrentBuffer];
+	if (buffer->Current == NULL)
+		return NULL;
+
+	FrameArenaBlock* block = buffer->Current;
+	size_t offset = FitInBlock(block, size, alignment);
+
+	while (offset > block->Capacity)
+	{
+		if (block->Next == NULL)
+		{
+			size_t capacity = size + alignment > s_BlockCapacity ? size + alignment : s_BlockCapacity;
+			block->Next = CreateBlock(capacity);
+			if (block->Next == NULL)
+			{
+				LSH_ERROR("Failed to chain a %zu KB frame arena block", capacity / 1024);
+				return NULL;
+			}
+
+			s_Stats.OverflowBlocks++;
+			LSH_WARN("Frame arena overflowed, chained a %zu KB block", capacity / 1024);
+		}
+
+		block = block->Next;
+		offset = FitInBlock(block, size, alignment);
+	}
+
+	buffer->Current = block;
+	buffer->Used += offset + size - block->Used;
+	buffer->Allocations++;
+	block->Used = offset + size;
+
+	return GetBlockData(block) + offset;
+}
+
+char* FormatFrameArena(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int length = vsnprintf(NULL, 0, fmt, args);
+	va_end(args);
+
+	if (length < 0)
+		return NULL;
+
+	char* result = (char*)AllocateFrameArena((size_t)length + 1, 1);
+	if (result == NULL)
+		return NULL;
+
+	va_start(args, fmt);
+	vsnprintf(result, (size_t)length + 1, fmt, args);
+	va_end(args);
+
+	return result;
+}
+
+const FrameArenaStats* GetFrameArenaStats()
+{
+	return &s_Stats;
+}
+
+void ShutdownFrameArena()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		FrameArenaBlock* block = s_Buffers[i].First;
+		while (block != NULL)
+		{
+			FrameArenaBlock* next = block->Next;
+			LSH_FREE(block);
+			block = next;
+		}
+
+		s_Buffers[i].First = NULL;
+		s_Buffers[i].Current = NULL;
+	}
+
+	if (s_Stats.OverflowBlocks > 0)
+		LSH_WARN("Frame arena chained %u overflow blocks, high water mark %zu KB of %zu KB per buffer",
+			s_Stats.OverflowBlocks, s_Stats.HighWaterMark / 1024, s_BlockCapacity / 1024);
+	else
+		LSH_TRACE("Frame arena high water mark: %zu KB of %zu KB", s_Stats.HighWaterMark / 1024, s_BlockCapacity / 1024);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LSH_FRAME_ARENA_CAPACITY (256 * 1024)
+#define LSH_FRAME_ARENA_DEFAULT_ALIGNMENT 16
+
+typedef struct FrameArenaStats
+{
+	size_t LastFrameUsed; // Bytes allocated between the last two resets
+	size_t HighWaterMark; // Largest LastFrameUsed so far, size LSH_FRAME_ARENA_CAPACITY after it
+	size_t Capacity; // Bytes reserved by both buffers, including overflow blocks
+	uint32_t LastFrameAllocations;
+	uint32_t OverflowBlocks; // Blocks chained because a buffer ran out
+} FrameArenaStats;
+
+// Two buffers are used in turns, memory allocated in a frame stays valid until the end of the next one
+int InitFrameArena(size_t capacity);
+
+// Switches to the other buffer and resets it, called at BeginRendering
+void BeginFrameArena();
+
+// Alignment must be a power of two, a new block is chained if the current one is full
+void* AllocateFrameArena(size_t size, size_t alignment);
+
+// printf into frame memory
+char* FormatFrameArena(const char* fmt, ...);
+
+const FrameArenaStats* GetFrameArenaStats();
+
+void ShutdownFrameArena();
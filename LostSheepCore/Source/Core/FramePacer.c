@@ -0,0 +1,155 @@
+#include "FramePacer.h"
+
+#include "Core/Clock.h"
+#include "Core/Log.h"
+#include "Core/Thread.h"
+#include "Core/Window.h"
+
+#include <math.h>
+#include <string.h>
+
+static FramePacingMode s_Mode = FramePacingMode_VSync;
+static uint64_t s_FramePeriod = 0; // Ticks, capped mode only
+
+// Sleep granularity can be as coarse as a scheduler tick, the remainder below this is spun
+static const double s_SpinThreshold = 2.0;
+
+static uint64_t s_NextFrameStart = 0;
+static uint64_t s_LastFrameStart = 0;
+static uint64_t s_LastPresent = 0;
+
+static float s_History[LSH_FRAME_PACER_HISTORY];
+static uint32_t s_HistoryIndex = 0;
+static FramePacerStats s_Stats;
+
+static const char* s_ModeNames[] = { "VSync", "Capped", "Unlimited" };
+
+static void WaitUntil(uint64_t deadline)
+{
+	uint64_t now = GetTicksClock();
+	while (now < deadline)
+	{
+		double remaining = TicksToMillisecondsClock(deadline - now);
+		if (remaining > s_SpinThreshold)
+			SleepThread((uint32_t)(remaining - s_SpinThreshold));
+		else
+			YieldThread();
+
+		now = GetTicksClock();
+	}
+}
+
+static void UpdateStats()
+{
+	uint32_t count = s_Stats.SampleCount;
+
+	float sum = 0.0f;
+	float min = s_History[0];
+	float max = s_History[0];
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sum += s_History[i];
+		if (s_History[i] < min)
+			min = s_History[i];
+		if (s_History[i] > max)
+			max = s_History[i];
+	}
+
+	float average = sum / (float)count;
+
+	float variance = 0.0f;
+	for (uint32_t i = 0; i < count; i++)
+		variance += (s_History[i] - average) * (s_History[i] - average);
+
+	s_Stats.AverageFrameTime = average;
+	s_Stats.MinFrameTime = min;
+	s_Stats.MaxFrameTime = max;
+	s_Stats.Jitter = sqrtf(variance / (float)count);
+}
+
+void InitFramePacer(FramePacingMode mode, float targetFramesPerSecond)
+{
+	memset(&s_Stats, 0, sizeof(FramePacerStats));
+	s_HistoryIndex = 0;
+	s_LastFrameStart = GetTicksClock();
+	s_LastPresent = 0;
+
+	SetFramePacingMode(mode, targetFramesPerSecond);
+}
+
+void SetFramePacingMode(FramePacingMode mode, float targetFramesPerSecond)
+{
+	if (mode == FramePacingMode_Capped && targetFramesPerSecond <= 0.0f)
+	{
+		LSH_WARN("Frame pacing cap of %.1f FPS is invalid, using vsync", targetFramesPerSecond);
+		mode = FramePacingMode_VSync;
+	}
+
+	s_Mode = mode;
+	s_FramePeriod = mode == FramePacingMode_Capped ? (uint64_t)((double)GetFrequencyClock() / targetFramesPerSecond) : 0;
+	s_NextFrameStart = 0;
+
+	SetVSyncWindow(mode == FramePacingMode_VSync);
+
+	if (mode == FramePacingMode_Capped)
+		LSH_TRACE("Frame pacing: %s at %.1f FPS", s_ModeNames[mode], targetFramesPerSecond);
+	else
+		LSH_TRACE("Frame pacing: %s", s_ModeNames[mode]);
+}
+
+FramePacingMode GetFramePacingMode()
+{
+	return s_Mode;
+}
+
+float BeginFramePacer()
+{
+	if (s_Mode == FramePacingMode_Capped)
+	{
+		uint64_t now = GetTicksClock();
+
+		// A frame that ran over a whole period resyncs instead of rushing to catch up
+		if (s_NextFrameStart == 0 || now > s_NextFrameStart + s_FramePeriod)
+			s_NextFrameStart = now;
+		else
+			WaitUntil(s_NextFrameStart);
+
+		s_NextFrameStart += s_FramePeriod;
+	}
+
+	uint64_t frameStart = GetTicksClock();
+	float deltaTime = (float)TicksToMillisecondsClock(frameStart - s_LastFrameStart);
+	s_LastFrameStart = frameStart;
+
+	return deltaTime;
+}
+
+void EndFramePacer(int presented)
+{
+	if (!presented)
+	{
+		s_LastPresent = 0;
+		return;
+	}
+
+	uint64_t now = GetTicksClock();
+	if (s_LastPresent != 0)
+	{
+		float frameTime = (float)TicksToMillisecondsClock(now - s_LastPresent);
+
+		s_History[s_HistoryIndex] = frameTime;
+		s_HistoryIndex = (s_HistoryIndex + 1) % LSH_FRAME_PACER_HISTORY;
+		if (s_Stats.SampleCount < LSH_FRAME_PACER_HISTORY)
+			s_Stats.SampleCount++;
+
+		s_Stats.FrameTime = frameTime;
+		UpdateStats();
+	}
+
+	s_LastPresent = now;
+}
+
+const FramePacerStats* GetFramePacerStats()
+{
+	return &s_Stats;
+}
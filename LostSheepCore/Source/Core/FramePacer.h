@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+#define LSH_FRAME_PACER_HISTORY 120
+
+typedef enum FramePacingMode
+{
+	FramePacingMode_VSync,
+	FramePacingMode_Capped, // Sleeps, then spins for the last stretch to hit the target frame time
+	FramePacingMode_Unlimited // No vsync and no waiting, for benchmarking
+} FramePacingMode;
+
+// Present to present intervals of the last LSH_FRAME_PACER_HISTORY consecutively presented frames, in milliseconds
+typedef struct FramePacerStats
+{
+	float FrameTime;
+	float AverageFrameTime;
+	float MinFrameTime;
+	float MaxFrameTime;
+	float Jitter; // Standard deviation of the frame time
+	uint32_t SampleCount;
+} FramePacerStats;
+
+// Needs a current context, the swap interval follows the mode
+void InitFramePacer(FramePacingMode mode, float targetFramesPerSecond);
+
+void SetFramePacingMode(FramePacingMode mode, float targetFramesPerSecond);
+
+FramePacingMode GetFramePacingMode();
+
+// Waits for the next frame slot in capped mode, returns the delta time since the last frame in milliseconds
+float BeginFramePacer();
+
+// Frames that weren't presented break the present to present chain and aren't sampled
+void EndFramePacer(int presented);
+
+const FramePacerStats* GetFramePacerStats();
@@ -0,0 +1,93 @@
+#include "FrameTimings.h"
+
+#include "Core/Clock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static FrameTimingSample s_Samples[LSH_FRAME_TIMING_SAMPLES];
+static uint32_t s_PushedCount = 0;
+
+static FrameTimingSample s_Current;
+static uint64_t s_FrameStart = 0;
+static uint64_t s_ZoneStarts[FrameTimingZone_Count];
+
+static FrameTimingPercentiles s_Percentiles[FrameTimingZone_Count];
+static uint32_t s_PercentilesPushedCount[FrameTimingZone_Count];
+
+void BeginFrameTimings()
+{
+	memset(&s_Current, 0, sizeof(s_Current));
+	s_FrameStart = GetTicksClock();
+}
+
+void BeginFrameTimingZone(FrameTimingZone zone)
+{
+	s_ZoneStarts[zone] = GetTicksClock();
+}
+
+void EndFrameTimingZone(FrameTimingZone zone)
+{
+	s_Current.Zones[zone] += (float)TicksToMillisecondsClock(GetTicksClock() - s_ZoneStarts[zone]);
+}
+
+float GetCurrentFrameTimingZone(FrameTimingZone zone)
+{
+	return s_Current.Zones[zone];
+}
+
+void EndFrameTimings()
+{
+	s_Current.Zones[FrameTimingZone_Frame] = (float)TicksToMillisecondsClock(GetTicksClock() - s_FrameStart);
+
+	s_Samples[s_PushedCount & (LSH_FRAME_TIMING_SAMPLES - 1)] = s_Current;
+	s_PushedCount++;
+}
+
+uint32_t GetFrameTimingCount()
+{
+	return s_PushedCount < LSH_FRAME_TIMING_SAMPLES ? s_PushedCount : LSH_FRAME_TIMING_SAMPLES;
+}
+
+const FrameTimingSample* GetFrameTimingSample(uint32_t index)
+{
+	uint32_t oldest = s_PushedCount - GetFrameTimingCount();
+	return &s_Samples[(oldest + index) & (LSH_FRAME_TIMING_SAMPLES - 1)];
+}
+
+static int CompareFloats(const void* a, const void* b)
+{
+	float x = *(const float*)a;
+	float y = *(const float*)b;
+	return (x > y) - (x < y);
+}
+
+// Nearest rank on a sorted copy, the ring is small enough to sort whole
+const FrameTimingPercentiles* GetFrameTimingPercentiles(FrameTimingZone zone)
+{
+	FrameTimingPercentiles* percentiles = &s_Percentiles[zone];
+	if (s_PercentilesPushedCount[zone] == s_PushedCount)
+		return percentiles;
+
+	s_PercentilesPushedCount[zone] = s_PushedCount;
+
+	uint32_t count = GetFrameTimingCount();
+	if (count == 0)
+	{
+		memset(percentiles, 0, sizeof(FrameTimingPercentiles));
+		return percentiles;
+	}
+
+	float sorted[LSH_FRAME_TIMING_SAMPLES];
+	for (uint32_t i = 0; i < count; i++)
+		sorted[i] = GetFrameTimingSample(i)->Zones[zone];
+
+	qsort(sorted, count, sizeof(float), CompareFloats);
+
+	percentiles->P50 = sorted[(count - 1) * 50 / 100];
+	percentiles->P95 = sorted[(count - 1) * 95 / 100];
+	percentiles->P99 = sorted[(count - 1) * 99 / 100];
+	percentiles->Max = sorted[count - 1];
+
+	return percentiles;
+}
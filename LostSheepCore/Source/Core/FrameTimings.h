@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+// Presented frames kept for the time graph, power of two
+#define LSH_FRAME_TIMING_SAMPLES 256
+
+typedef enum FrameTimingZone
+{
+	FrameTimingZone_Frame, // From input polling to the end of the swap, idle waits are not counted
+	FrameTimingZone_Layout,
+	FrameTimingZone_Submit,
+	FrameTimingZone_Swap,
+
+	FrameTimingZone_Count
+} FrameTimingZone;
+
+// Milliseconds spent in each zone
+typedef struct FrameTimingSample
+{
+	float Zones[FrameTimingZone_Count];
+} FrameTimingSample;
+
+typedef struct FrameTimingPercentiles
+{
+	float P50;
+	float P95;
+	float P99;
+	float Max;
+} FrameTimingPercentiles;
+
+// Starts the frame zone and clears the other zones
+void BeginFrameTimings();
+
+// A zone may be entered more than once per frame, the times add up
+void BeginFrameTimingZone(FrameTimingZone zone);
+
+void EndFrameTimingZone(FrameTimingZone zone);
+
+// Milliseconds spent in the zone so far this frame
+float GetCurrentFrameTimingZone(FrameTimingZone zone);
+
+// Pushes the frame into the ring, skipped frames are not pushed
+void EndFrameTimings();
+
+uint32_t GetFrameTimingCount();
+
+// Index 0 is the oldest sample still in the ring
+const FrameTimingSample* GetFrameTimingSample(uint32_t index);
+
+// Over the samples in the ring, recomputed only when a frame was pushed since the last call
+const FrameTimingPercentiles* GetFrameTimingPercentiles(FrameTimingZone zone);
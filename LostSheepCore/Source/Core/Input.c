@@ -2,40 +2,213 @@
 
 #include "Core/Window.h"
 #include "Log.h"
+
+#include "Event/Event.h"
+
 #include "GLFW/glfw3.h"
 
-int IsKeyPressed(const KeyCode keycode)
+#include <stdint.h>
+#include <string.h>
+
+#define LSH_INPUT_KEY_WORDS ((LSH_KEY_LAST + 32) / 32)
+#define LSH_INPUT_BUTTON_WORDS ((LSH_MOUSE_BUTTON_LAST + 32) / 32)
+
+typedef struct InputState
 {
+    uint32_t KeysDown[LSH_INPUT_KEY_WORDS];
+    uint32_t KeysPressed[LSH_INPUT_KEY_WORDS];
+    uint32_t KeysReleased[LSH_INPUT_KEY_WORDS];
+
+    uint32_t ButtonsDown[LSH_INPUT_BUTTON_WORDS];
+    uint32_t ButtonsPressed[LSH_INPUT_BUTTON_WORDS];
+    uint32_t ButtonsReleased[LSH_INPUT_BUTTON_WORDS];
+
+    double MouseX;
+    double MouseY;
+    double ScrollX;
+    double ScrollY;
+
+    double FrameTimestamp;
+} InputState;
+
+static InputState s_Input;
+
+static void SetBit(uint32_t* bits, int index, int value)
+{
+    uint32_t mask = 1u << (index & 31);
+    if (value)
+        bits[index >> 5] |= mask;
+    else
+        bits[index >> 5] &= ~mask;
+}
+
+static int GetBit(const uint32_t* bits, int index, int last)
+{
+    if (index < 0 || index > last)
+        return 0;
+    return (bits[index >> 5] >> (index & 31)) & 1u;
+}
+
+static void NoteInputEvent(const Event* event)
+{
+    if (s_Input.FrameTimestamp == 0.0 || event->Timestamp < s_Input.FrameTimestamp)
+        s_Input.FrameTimestamp = event->Timestamp;
+}
+
+static int OnKeyInput(Event* event)
+{
+    int key = event->Payload.Key.Key;
+    if (key < 0 || key > LSH_KEY_LAST)
+        return 0;
+
+    NoteInputEvent(event);
+
+    if (event->Type == EventTypeKeyPressed)
+    {
+        SetBit(s_Input.KeysDown, key, 1);
+        SetBit(s_Input.KeysPressed, key, 1);
+    }
+    else if (event->Type == EventTypeKeyReleased)
+    {
+        SetBit(s_Input.KeysDown, key, 0);
+        SetBit(s_Input.KeysReleased, key, 1);
+    }
+
+    return 0;
+}
+
+static int OnMouseButtonInput(Event* event)
+{
+    int button = event->Payload.MouseButton.Button;
+    if (button < 0 || button > LSH_MOUSE_BUTTON_LAST)
+        return 0;
+
+    NoteInputEvent(event);
+
+    if (event->Type == EventTypeMouseButtonPressed)
+    {
+        SetBit(s_Input.ButtonsDown, button, 1);
+        SetBit(s_Input.ButtonsPressed, button, 1);
+    }
+    else if (event->Type == EventTypeMouseButtonReleased)
+    {
+        SetBit(s_Input.ButtonsDown, button, 0);
+        SetBit(s_Input.ButtonsReleased, button, 1);
+    }
+
+    return 0;
+}
+
+static int OnMouseMoveInput(Event* event)
+{
+    NoteInputEvent(event);
+    s_Input.MouseX = event->Payload.MousePosition.X;
+    s_Input.MouseY = event->Payload.MousePosition.Y;
+    return 0;
+}
+
+static int OnMouseScrollInput(Event* event)
+{
+    NoteInputEvent(event);
+    s_Input.ScrollX += event->Payload.MouseScroll.XOffset;
+    s_Input.ScrollY += event->Payload.MouseScroll.YOffset;
+    return 0;
+}
+
+void InitInput()
+{
+    memset(&s_Input, 0, sizeof(InputState));
+
+    // Only place the platform is queried, later state comes from events
     GLFWwindow* window = GetNativeWindow();
-    int state = glfwGetKey(window, keycode);
-    return state == GLFW_PRESS || state == GLFW_REPEAT;
+    glfwGetCursorPos(window, &s_Input.MouseX, &s_Input.MouseY);
+    for (int button = 0; button <= LSH_MOUSE_BUTTON_LAST; button++)
+        SetBit(s_Input.ButtonsDown, button, glfwGetMouseButton(window, button) == GLFW_PRESS);
+
+    SubscribeEvent(EventTypeKeyPressed, OnKeyInput, EventPriorityInput);
+    SubscribeEvent(EventTypeKeyReleased, OnKeyInput, EventPriorityInput);
+    SubscribeEvent(EventTypeMouseButtonPressed, OnMouseButtonInput, EventPriorityInput);
+    SubscribeEvent(EventTypeMouseButtonReleased, OnMouseButtonInput, EventPriorityInput);
+    SubscribeEvent(EventTypeMouseMoved, OnMouseMoveInput, EventPriorityInput);
+    SubscribeEvent(EventTypeMouseScrolled, OnMouseScrollInput, EventPriorityInput);
+
+    LSH_TRACE("Input initialized");
+}
+
+void BeginInputFrame()
+{
+    memset(s_Input.KeysPressed, 0, sizeof(s_Input.KeysPressed));
+    memset(s_Input.KeysReleased, 0, sizeof(s_Input.KeysReleased));
+    memset(s_Input.ButtonsPressed, 0, sizeof(s_Input.ButtonsPressed));
+    memset(s_Input.ButtonsReleased, 0, sizeof(s_Input.ButtonsReleased));
+    s_Input.ScrollX = 0.0;
+    s_Input.ScrollY = 0.0;
+    s_Input.FrameTimestamp = 0.0;
+}
+
+void ShutdownInput()
+{
+    UnsubscribeEvent(EventTypeKeyPressed, OnKeyInput);
+    UnsubscribeEvent(EventTypeKeyReleased, OnKeyInput);
+    UnsubscribeEvent(EventTypeMouseButtonPressed, OnMouseButtonInput);
+    UnsubscribeEvent(EventTypeMouseButtonReleased, OnMouseButtonInput);
+    UnsubscribeEvent(EventTypeMouseMoved, OnMouseMoveInput);
+    UnsubscribeEvent(EventTypeMouseScrolled, OnMouseScrollInput);
+}
+
+double GetInputFrameTimestamp()
+{
+    return s_Input.FrameTimestamp;
+}
+
+int IsKeyPressed(const KeyCode keycode)
+{
+    return GetBit(s_Input.KeysDown, keycode, LSH_KEY_LAST);
+}
+
+int WasKeyPressedThisFrame(const KeyCode keycode)
+{
+    return GetBit(s_Input.KeysPressed, keycode, LSH_KEY_LAST);
+}
+
+int WasKeyReleasedThisFrame(const KeyCode keycode)
+{
+    return GetBit(s_Input.KeysReleased, keycode, LSH_KEY_LAST);
 }
 
 int IsMouseButtonPressed(const MouseCode button)
 {
-    GLFWwindow* window = GetNativeWindow();
-    int state = glfwGetMouseButton(window, button);
-    return state == GLFW_PRESS || state == GLFW_REPEAT;
+    return GetBit(s_Input.ButtonsDown, button, LSH_MOUSE_BUTTON_LAST);
+}
+
+int WasMouseButtonPressedThisFrame(const MouseCode button)
+{
+    return GetBit(s_Input.ButtonsPressed, button, LSH_MOUSE_BUTTON_LAST);
+}
+
+int WasMouseButtonReleasedThisFrame(const MouseCode button)
+{
+    return GetBit(s_Input.ButtonsReleased, button, LSH_MOUSE_BUTTON_LAST);
 }
 
 void GetMousePosition(double* xPos, double* yPos)
 {
-    GLFWwindow* window = GetNativeWindow();
-    glfwGetCursorPos(window, xPos, yPos);
+    *xPos = s_Input.MouseX;
+    *yPos = s_Input.MouseY;
 }
 
 float GetMouseX()
 {
-    double xPos = 0.0f;
-    GLFWwindow* window = GetNativeWindow();
-    glfwGetCursorPos(window, &xPos, NULL);
-    return (float)xPos;
+    return (float)s_Input.MouseX;
 }
 
 float GetMouseY()
 {
-    double yPos = 0.0f;
-    GLFWwindow* window = GetNativeWindow();
-    glfwGetCursorPos(window, NULL, &yPos);
-    return (float)yPos;
+    return (float)s_Input.MouseY;
+}
+
+void GetMouseScroll(double* xOffset, double* yOffset)
+{
+    *xOffset = s_Input.ScrollX;
+    *yOffset = s_Input.ScrollY;
 }
@@ -5,9 +5,33 @@
 
 typedef float vec2[2];
 
+// Input is a snapshot built from the event stream, queries never call into the platform
+
+// Seeds the snapshot from the window and subscribes to input events
+void InitInput();
+
+// Clears the per-frame edges and scroll, call before the frame's events are dispatched
+void BeginInputFrame();
+
+void ShutdownInput();
+
+// Timestamp of the oldest input event of this frame, 0 if there was none
+double GetInputFrameTimestamp();
+
+// Held down, including repeats
 int IsKeyPressed(const KeyCode keycode);
 
+// Went down or up during this frame
+int WasKeyPressedThisFrame(const KeyCode keycode);
+int WasKeyReleasedThisFrame(const KeyCode keycode);
+
 int IsMouseButtonPressed(const MouseCode button);
+int WasMouseButtonPressedThisFrame(const MouseCode button);
+int WasMouseButtonReleasedThisFrame(const MouseCode button);
+
 void GetMousePosition(double* xPos, double* yPos);
 float GetMouseX();
-float GetMouseY();
\ No newline at end of file
+float GetMouseY();
+
+// Scroll offsets accumulated during this frame
+void GetMouseScroll(double* xOffset, double* yOffset);
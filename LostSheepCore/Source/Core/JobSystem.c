@@ -0,0 +1,332 @@
+#include "JobSystem.h"
+
+#include "Core/Atomic.h"
+#include "Core/Channel.h"
+#include "Core/Log.h"
+#include "Core/Memory.h"
+#include "Core/Profiler.h"
+#include "Core/Thread.h"
+
+#include <string.h>
+
+#define LSH_JOB_MAX_WORKERS 64
+#define LSH_JOB_MAX_PARALLEL_FOR_BATCHES 256
+
+// Chase-Lev deque: the owning thread pushes and pops at the bottom, other threads steal from the top
+typedef struct JobQueue
+{
+	Job Jobs[LSH_JOB_QUEUE_CAPACITY];
+
+	volatile uint32_t Top;
+	char TopPadding[LSH_CACHE_LINE_SIZE - sizeof(uint32_t)];
+
+	volatile uint32_t Bottom;
+	char BottomPadding[LSH_CACHE_LINE_SIZE - sizeof(uint32_t)];
+} JobQueue;
+
+typedef struct ParallelForBatch
+{
+	ParallelForFn Function;
+	void* UserData;
+	uint32_t Start;
+	uint32_t End;
+} ParallelForBatch;
+
+// Workers own the first queues, external threads claim one of the rest on first use
+static JobQueue* s_Queues = NULL;
+static uint32_t s_QueueCount = 0;
+static uint32_t s_WorkerCount = 0;
+static volatile uint32_t s_NextExternalQueue = 0;
+
+static Thread s_Workers[LSH_JOB_MAX_WORKERS];
+static uint32_t s_WorkerIndices[LSH_JOB_MAX_WORKERS];
+static volatile uint32_t s_Running = 0;
+
+// Idle workers sleep on the semaphore, pending jobs are counted so a kick can't be missed
+static Semaphore s_WorkAvailable;
+static volatile uint32_t s_PendingJobs = 0;
+static volatile uint32_t s_SleepingWorkers = 0;
+
+static LSH_THREAD_LOCAL int32_t s_QueueIndex = -1;
+
+static int PushJob(JobQueue* queue, const Job* job)
+{
+	uint32_t bottom = queue->Bottom;
+	uint32_t top = AtomicLoad32(&queue->Top);
+	if ((int32_t)(bottom - top) >= LSH_JOB_QUEUE_CAPACITY)
+		return 0;
+
+	queue->Jobs[bottom & (LSH_JOB_QUEUE_CAPACITY - 1)] = *job;
+	AtomicStore32(&queue->Bottom, bottom + 1);
+
+	return 1;
+}
+
+static int PopJob(JobQueue* queue, Job* job)
+{
+	uint32_t bottom = queue->Bottom - 1;
+	AtomicStore32(&queue->Bottom, bottom);
+	AtomicFence();
+	uint32_t top = AtomicLoad32(&queue->Top);
+
+	if ((int32_t)(bottom - top) < 0)
+	{
+		AtomicStore32(&queue->Bottom, top);
+		return 0;
+	}
+
+	*job = queue->Jobs[bottom & (LSH_JOB_QUEUE_CAPACITY - 1)];
+	if (bottom != top)
+		return 1;
+
+	// Last job, a thief may be taking it at the same time
+	int won = AtomicCompareExchange32(&queue->Top, top, top + 1);
+	AtomicStore32(&queue->Bottom, top + 1);
+
+	return won;
+}
+
+static int StealJob(JobQueue* queue, Job* job)
+{
+	uint32_t top = AtomicLoad32(&queue->Top);
+	AtomicFence();
+	uint32_t bottom = AtomicLoad32(&queue->Bottom);
+
+	if ((int32_t)(bottom - top) <= 0)
+		return 0;
+
+	*job = queue->Jobs[top & (LSH_JOB_QUEUE_CAPACITY - 1)];
+
+	return AtomicCompareExchange32(&queue->Top, top, top + 1);
+}
+
+static JobQueue* GetThreadQueue()
+{
+	if (s_QueueIndex < 0)
+	{
+		uint32_t external = AtomicAdd32(&s_NextExternalQueue, 1);
+		if (external >= LSH_JOB_MAX_EXTERNAL_THREADS)
+			return NULL;
+
+		s_QueueIndex = (int32_t)(s_WorkerCount + external);
+	}
+
+	return &s_Queues[s_QueueIndex];
+}
+
+static void RunJob(const Job* job)
+{
+	AtomicAdd32(&s_PendingJobs, (uint32_t)-1);
+
+	LSH_PROFILE_BEGIN("Job");
+	job->Function(job->UserData);
+	LSH_PROFILE_END();
+
+	if (job->Counter != NULL)
+		AtomicAdd32(&job->Counter->Value, (uint32_t)-1);
+}
+
+// Own queue first, then steal starting from the next queue over
+static int TryRunJob()
+{
+	Job job;
+	JobQueue* own = GetThreadQueue();
+	if (own != NULL && PopJob(own, &job))
+	{
+		RunJob(&job);
+		return 1;
+	}
+
+	uint32_t start = s_QueueIndex >= 0 ? (uint32_t)s_QueueIndex + 1 : 0;
+	for (uint32_t i = 0; i < s_QueueCount; i++)
+	{
+		JobQueue* victim = &s_Queues[(start + i) % s_QueueCount];
+		if (victim != own && StealJob(victim, &job))
+		{
+			RunJob(&job);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void WorkerMain(void* userData)
+{
+	s_QueueIndex = (int32_t)*(uint32_t*)userData;
+	SetProfileThreadName("Job Worker");
+
+	while (AtomicLoad32(&s_Running))
+	{
+		if (TryRunJob())
+			continue;
+
+		// Announce the sleep before the last look, a kick either sees a sleeper or its job is seen here
+		AtomicAdd32(&s_SleepingWorkers, 1);
+		if (AtomicLoad32(&s_PendingJobs) == 0 && AtomicLoad32(&s_Running))
+			WaitSemaphore(&s_WorkAvailable);
+		AtomicAdd32(&s_SleepingWorkers, (uint32_t)-1);
+	}
+}
+
+int InitJobSystem(uint32_t workerCount)
+{
+	if (workerCount == 0)
+	{
+		uint32_t cores = GetProcessorCountThread();
+		workerCount = cores > 1 ? cores - 1 : 0;
+	}
+	if (workerCount > LSH_JOB_MAX_WORKERS)
+		workerCount = LSH_JOB_MAX_WORKERS;
+
+	s_QueueCount = workerCount + LSH_JOB_MAX_EXTERNAL_THREADS;
+	s_Queues = (JobQueue*)LSH_MALLOC(sizeof(JobQueue) * s_QueueCount, MemoryTag_Core);
+	if (s_Queues == NULL)
+	{
+		LSH_FATAL("Failed to allocate memory for job queues");
+		return 0;
+	}
+	memset(s_Queues, 0, sizeof(JobQueue) * s_QueueCount);
+
+	if (!InitSemaphore(&s_WorkAvailable, 0))
+	{
+		LSH_FREE(s_Queues);
+		s_Queues = NULL;
+		return 0;
+	}
+
+	s_WorkerCount = 0;
+	s_NextExternalQueue = 0;
+	s_PendingJobs = 0;
+	s_SleepingWorkers = 0;
+	AtomicStore32(&s_Running, 1);
+
+	uint32_t startedCount = 0;
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		s_WorkerIndices[i] = i;
+		if (!StartThread(&s_Workers[i], WorkerMain, &s_WorkerIndices[i]))
+		{
+			LSH_ERROR("Failed to start job worker %u, running with %u of %u workers", i, startedCount, workerCount);
+			break;
+		}
+		startedCount++;
+	}
+
+	// Queues of workers that didn't start stay empty, external queues follow the started ones
+	s_WorkerCount = startedCount;
+
+	// The initializing thread always gets a queue
+	GetThreadQueue();
+
+	LSH_TRACE("Job system initialized with %u workers", s_WorkerCount);
+
+	return 1;
+}
+
+uint32_t GetWorkerCountJobSystem()
+{
+	return s_WorkerCount;
+}
+
+void KickJobs(const Job* jobs, uint32_t count, JobCounter* counter)
+{
+	if (counter != NULL)
+		AtomicAdd32(&counter->Value, count);
+
+	JobQueue* queue = s_Queues != NULL ? GetThreadQueue() : NULL;
+
+	uint32_t queued = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		Job job = jobs[i];
+		job.Counter = counter;
+
+		AtomicAdd32(&s_PendingJobs, 1);
+		if (queue != NULL && PushJob(queue, &job))
+		{
+			queued++;
+			continue;
+		}
+
+		// No queue for this thread or it is full
+		RunJob(&job);
+	}
+
+	uint32_t sleeping = AtomicLoad32(&s_SleepingWorkers);
+	SignalSemaphore(&s_WorkAvailable, queued < sleeping ? queued : sleeping);
+}
+
+void WaitForCounter(JobCounter* counter)
+{
+	while (AtomicLoad32(&counter->Value) != 0)
+	{
+		if (!TryRunJob())
+			YieldThread();
+	}
+}
+
+static void RunParallelForBatch(void* userData)
+{
+	ParallelForBatch* batch = (ParallelForBatch*)userData;
+	batch->Function(batch->Start, batch->End, batch->UserData);
+}
+
+void ParallelFor(uint32_t count, uint32_t minBatchSize, ParallelForFn function, void* userData)
+{
+	if (count == 0)
+		return;
+	if (minBatchSize == 0)
+		minBatchSize = 1;
+
+	// A few batches per thread so stealing can even out uneven work
+	uint32_t threadCount = s_WorkerCount + 1;
+	uint32_t batchSize = (count + threadCount * 4 - 1) / (threadCount * 4);
+	if (batchSize < minBatchSize)
+		batchSize = minBatchSize;
+	if ((count + batchSize - 1) / batchSize > LSH_JOB_MAX_PARALLEL_FOR_BATCHES)
+		batchSize = (count + LSH_JOB_MAX_PARALLEL_FOR_BATCHES - 1) / LSH_JOB_MAX_PARALLEL_FOR_BATCHES;
+
+	uint32_t batchCount = (count + batchSize - 1) / batchSize;
+	if (batchCount == 1 || s_WorkerCount == 0)
+	{
+		function(0, count, userData);
+		return;
+	}
+
+	ParallelForBatch batches[LSH_JOB_MAX_PARALLEL_FOR_BATCHES];
+	Job jobs[LSH_JOB_MAX_PARALLEL_FOR_BATCHES];
+	for (uint32_t i = 0; i < batchCount; i++)
+	{
+		batches[i].Function = function;
+		batches[i].UserData = userData;
+		batches[i].Start = i * batchSize;
+		batches[i].End = batches[i].Start + batchSize < count ? batches[i].Start + batchSize : count;
+
+		jobs[i].Function = RunParallelForBatch;
+		jobs[i].UserData = &batches[i];
+		jobs[i].Counter = NULL;
+	}
+
+	JobCounter counter = { 0 };
+	KickJobs(jobs, batchCount, &counter);
+	WaitForCounter(&counter);
+}
+
+void ShutdownJobSystem()
+{
+	if (s_Queues == NULL)
+		return;
+
+	AtomicStore32(&s_Running, 0);
+	SignalSemaphore(&s_WorkAvailable, s_WorkerCount);
+
+	for (uint32_t i = 0; i < s_WorkerCount; i++)
+		JoinThread(&s_Workers[i]);
+
+	ShutdownSemaphore(&s_WorkAvailable);
+	LSH_FREE(s_Queues);
+	s_Queues = NULL;
+
+	LSH_TRACE("Shutdown job system");
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+// Jobs per thread queue, kicking into a full queue runs the job right away
+#define LSH_JOB_QUEUE_CAPACITY 1024
+// Threads other than the workers that may kick jobs, e.g. the main and render threads
+#define LSH_JOB_MAX_EXTERNAL_THREADS 4
+
+typedef void (*JobFn)(void* userData);
+
+// Number of unfinished jobs, a job's dependencies are the counters it waits on
+typedef struct JobCounter
+{
+	volatile uint32_t Value;
+} JobCounter;
+
+typedef struct Job
+{
+	JobFn Function;
+	void* UserData;
+	JobCounter* Counter; // Optional, decremented once the job has run
+} Job;
+
+// Processes [start, end) of a ParallelFor range
+typedef void (*ParallelForFn)(uint32_t start, uint32_t end, void* userData);
+
+// 0 workers uses one per core besides the calling thread
+int InitJobSystem(uint32_t workerCount);
+
+uint32_t GetWorkerCountJobSystem();
+
+// The counter is incremented by count before any of the jobs can run
+void KickJobs(const Job* jobs, uint32_t count, JobCounter* counter);
+
+// Runs queued jobs on the calling thread until the counter reaches zero
+void WaitForCounter(JobCounter* counter);
+
+// Splits [0, count) into batches of at least minBatchSize and waits for all of them
+void ParallelFor(uint32_t count, uint32_t minBatchSize, ParallelForFn function, void* userData);
+
+void ShutdownJobSystem();
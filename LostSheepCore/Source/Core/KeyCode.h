@@ -124,6 +124,7 @@ typedef enum KeyCode
 	LSH_KEY_RIGHT_CONTROL = 345,
 	LSH_KEY_RIGHT_ALT = 346,
 	LSH_KEY_RIGHT_SUPER = 347,
-	LSH_KEY_MENU = 348
+	LSH_KEY_MENU = 348,
 
+	LSH_KEY_LAST = LSH_KEY_MENU
 } KeyCode;
\ No newline at end of file
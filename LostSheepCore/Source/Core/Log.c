@@ -1,84 +1,748 @@
 #include "Log.h"
 
+#include "Core/Atomic.h"
+#include "Core/Channel.h"
+#include "Core/Thread.h"
+
+#include <ctype.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include <time.h>
 
+#ifdef LSH_PLATFORM_WINDOWS
+#include <direct.h>
+#define MakeDirectory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MakeDirectory(path) mkdir(path, 0755)
+#endif
+
 #define GREEN_STRING(string) "\x1b[92m" string "\x1b[0m"
 #define YELLOW_STRING(string) "\x1b[93m" string "\x1b[0m"
 #define BRIGHT_RED_STRING(string) "\x1b[91m" string "\x1b[0m"
 #define RED_STRING(string) "\x1b[31m" string "\x1b[0m"
 
-static const char* GetCurrentTimeString()
+// Slot of a bounded MPSC ring, the sequence tells producers and the writer whose turn the slot is
+typedef struct LogRecord
+{
+	volatile uint32_t Sequence;
+	LogLevel Level;
+	LogCategory Category;
+	time_t Time;
+	const char* Format; // Set for deferred records, Message then holds the captured arguments
+	uint32_t ArgumentsSize;
+	char Message[LSH_LOG_MESSAGE_SIZE];
+} LogRecord;
+
+typedef enum LogArgumentType
+{
+	LogArgumentType_None, // Unsupported conversion, the message is formatted at the call site instead
+	LogArgumentType_Percent, // Literal %%
+	LogArgumentType_Int,
+	LogArgumentType_Long,
+	LogArgumentType_LongLong,
+	LogArgumentType_Size,
+	LogArgumentType_Double,
+	LogArgumentType_LongDouble,
+	LogArgumentType_Pointer,
+	LogArgumentType_String
+} LogArgumentType;
+
+// One printf conversion, Length covers the text from '%' up to and including the conversion character
+typedef struct LogConversion
+{
+	LogArgumentType Type;
+	uint32_t StarCount; // Width and precision given as int arguments
+	int Precision; // LOG_PRECISION_NONE, LOG_PRECISION_STAR or the literal value
+	uint32_t Length;
+} LogConversion;
+
+#define LOG_PRECISION_NONE -1
+#define LOG_PRECISION_STAR -2
+
+static LogRecord s_Records[LSH_LOG_QUEUE_CAPACITY];
+
+// Claimed by producers with a compare exchange
+static volatile uint32_t s_EnqueuePosition = 0;
+static char s_EnqueuePadding[LSH_CACHE_LINE_SIZE - sizeof(uint32_t)];
+
+// Only the writer thread moves this
+static volatile uint32_t s_DequeuePosition = 0;
+
+static Thread s_WriterThread;
+static Semaphore s_RecordsAvailable;
+static volatile uint32_t s_WriterRunning = 0;
+
+// Producers only queue while accepting, the ones past that check are counted so shutdown can wait for them
+static volatile uint32_t s_AcceptingRecords = 0;
+static volatile uint32_t s_ActiveProducers = 0;
+static volatile uint32_t s_WriterSleeping = 0;
+static volatile uint32_t s_DroppedRecords = 0;
+
+static const char* s_LogDirectory = "Logs";
+static const char* s_LogPath = "Logs/LostSheep.log";
+static FILE* s_LogFile = NULL;
+static long s_LogFileSize = 0;
+
+static const char* s_LevelNames[] = { "TRACE", "INFO", "WARN", "ERROR", "FATAL" };
+static const char* s_CategoryNames[LogCategory_Count] = { "Core", "Event", "Renderer", "Text", "UI", "Assets" };
+
+static volatile uint32_t s_CategoryLevels[LogCategory_Count];
+static volatile uint32_t s_DeferredFormatting = 0;
+
+// localtime and strftime only run when the second changes
+static time_t s_CachedTime = 0;
+static char s_CachedTimeString[9];
+
+static const char* GetTimeString(time_t time)
+{
+	if (time != s_CachedTime || s_CachedTimeString[0] == '\0')
+	{
+		struct tm* t = localtime(&time);
+		strftime(s_CachedTimeString, sizeof(s_CachedTimeString), "%H:%M:%S", t);
+		s_CachedTime = time;
+	}
+
+	return s_CachedTimeString;
+}
+
+// LostSheep.log becomes LostSheep.1.log and so on, the oldest backup is dropped
+static void RotateLogFile()
+{
+	if (s_LogFile != NULL)
+	{
+		fclose(s_LogFile);
+		s_LogFile = NULL;
+	}
+
+	char from[256];
+	char to[256];
+	for (int i = LSH_LOG_FILE_BACKUPS - 1; i >= 0; i--)
+	{
+		if (i == 0)
+			snprintf(from, sizeof(from), "%s", s_LogPath);
+		else
+			snprintf(from, sizeof(from), "%s/LostSheep.%d.log", s_LogDirectory, i);
+		snprintf(to, sizeof(to), "%s/LostSheep.%d.log", s_LogDirectory, i + 1);
+
+		remove(to);
+		rename(from, to);
+	}
+
+	s_LogFile = fopen(s_LogPath, "w");
+	s_LogFileSize = 0;
+}
+
+static void WriteRecord(LogLevel level, time_t time, const char* message)
+{
+	const char* timeString = GetTimeString(time);
+
+	switch (level)
+	{
+	case LogLevel_Trace:
+		printf("[%s] LostSheep: %s\n", timeString, message);
+		break;
+	case LogLevel_Info:
+		printf(GREEN_STRING("[%s] LostSheep: ") GREEN_STRING("%s\n"), timeString, message);
+		break;
+	case LogLevel_Warn:
+		printf(YELLOW_STRING("[%s] LostSheep: ") YELLOW_STRING("%s\n"), timeString, message);
+		break;
+	case LogLevel_Error:
+		printf(RED_STRING("[%s] LostSheep: ") RED_STRING("%s\n"), timeString, message);
+		break;
+	case LogLevel_Fatal:
+		printf(RED_STRING("[%s] FATAL: ") RED_STRING("%s\n"), timeString, message);
+		break;
+	}
+
+	if (s_LogFile != NULL)
+	{
+		int written = fprintf(s_LogFile, "[%s] %s: %s\n", timeString, s_LevelNames[level], message);
+		if (written > 0)
+			s_LogFileSize += written;
+
+		if (s_LogFileSize > LSH_LOG_FILE_MAX_SIZE)
+			RotateLogFile();
+	}
+}
+
+static void FlushOutput()
+{
+	fflush(stdout);
+	if (s_LogFile != NULL)
+		fflush(s_LogFile);
+}
+
+static LogConversion ParseConversion(const char* spec)
+{
+	LogConversion conversion = { LogArgumentType_None, 0, LOG_PRECISION_NONE, 1 };
+	const char* c = spec + 1;
+
+	while (*c == '-' || *c == '+' || *c == ' ' || *c == '#' || *c == '0')
+		c++;
+
+	if (*c == '*')
+	{
+		conversion.StarCount++;
+		c++;
+	}
+	while (isdigit((unsigned char)*c))
+		c++;
+
+	if (*c == '.')
+	{
+		c++;
+		if (*c == '*')
+		{
+			conversion.StarCount++;
+			conversion.Precision = LOG_PRECISION_STAR;
+			c++;
+		}
+		else
+		{
+			conversion.Precision = 0;
+			while (isdigit((unsigned char)*c))
+			{
+				conversion.Precision = conversion.Precision * 10 + (*c - '0');
+				c++;
+			}
+		}
+	}
+
+	int longCount = 0;
+	int isSize = 0;
+	int isLongDouble = 0;
+	while (*c == 'h' || *c == 'l' || *c == 'z' || *c == 'j' || *c == 't' || *c == 'L')
+	{
+		if (*c == 'l')
+			longCount++;
+		else if (*c == 'z' || *c == 't')
+			isSize = 1;
+		else if (*c == 'j')
+			longCount = 2;
+		else if (*c == 'L')
+			isLongDouble = 1;
+		c++;
+	}
+
+	switch (*c)
+	{
+	case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+		if (isSize)
+			conversion.Type = LogArgumentType_Size;
+		else if (longCount >= 2)
+			conversion.Type = LogArgumentType_LongLong;
+		else if (longCount == 1)
+			conversion.Type = LogArgumentType_Long;
+		else
+			conversion.Type = LogArgumentType_Int;
+		break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		conversion.Type = isLongDouble ? LogArgumentType_LongDouble : LogArgumentType_Double;
+		break;
+	case 'p':
+		conversion.Type = LogArgumentType_Pointer;
+		break;
+	case 's':
+		conversion.Type = LogArgumentType_String;
+		break;
+	case '%':
+		conversion.Type = LogArgumentType_Percent;
+		break;
+	default:
+		break;
+	}
+
+	if (*c != '\0')
+		c++;
+	conversion.Length = (uint32_t)(c - spec);
+
+	return conversion;
+}
+
+#define LOG_CAPTURE(type, arguments, buffer, size, capacity)			\
+	do {																\
+		type value = va_arg(arguments, type);							\
+		if (size + sizeof(type) > capacity)								\
+			return 0;													\
+		memcpy(buffer + size, &value, sizeof(type));					\
+		size += (uint32_t)sizeof(type);									\
+	} while (0)
+
+// Returns the number of bytes written or 0 if the arguments don't fit or a conversion isn't supported
+static uint32_t CaptureArguments(const char* fmt, va_list args, unsigned char* buffer, uint32_t capacity)
+{
+	uint32_t size = 0;
+
+	for (const char* c = fmt; *c != '\0'; c++)
+	{
+		if (*c != '%')
+			continue;
+
+		LogConversion conversion = ParseConversion(c);
+		c += conversion.Length - 1;
+
+		// Things like %n can't be replayed later, skipping them would misalign the remaining arguments
+		if (conversion.Type == LogArgumentType_None)
+			return 0;
+
+		int precision = conversion.Precision;
+		for (uint32_t i = 0; i < conversion.StarCount; i++)
+		{
+			int star = va_arg(args, int);
+			if (size + sizeof(int) > capacity)
+				return 0;
+			memcpy(buffer + size, &star, sizeof(int));
+			size += (uint32_t)sizeof(int);
+
+			// The precision star comes after the width star
+			if (precision == LOG_PRECISION_STAR && i == conversion.StarCount - 1)
+				precision = star >= 0 ? star : LOG_PRECISION_NONE;
+		}
+
+		switch (conversion.Type)
+		{
+		case LogArgumentType_Int: LOG_CAPTURE(int, args, buffer, size, capacity); break;
+		case LogArgumentType_Long: LOG_CAPTURE(long, args, buffer, size, capacity); break;
+		case LogArgumentType_LongLong: LOG_CAPTURE(long long, args, buffer, size, capacity); break;
+		case LogArgumentType_Size: LOG_CAPTURE(size_t, args, buffer, size, capacity); break;
+		case LogArgumentType_Double: LOG_CAPTURE(double, args, buffer, size, capacity); break;
+		case LogArgumentType_LongDouble: LOG_CAPTURE(long double, args, buffer, size, capacity); break;
+		case LogArgumentType_Pointer: LOG_CAPTURE(void*, args, buffer, size, capacity); break;
+		case LogArgumentType_String:
+		{
+			// The pointed to string may be gone by the time the record is written,
+			// with a precision it doesn't need to be terminated, e.g. %.*s over Clay strings
+			const char* string = va_arg(args, const char*);
+			if (string == NULL)
+				string = "(null)";
+
+			size_t length = 0;
+			if (precision >= 0)
+			{
+				while (length < (size_t)precision && string[length] != '\0')
+					length++;
+			}
+			else
+			{
+				length = strlen(string);
+			}
+
+			if (size + length + 1 > capacity)
+				return 0;
+			memcpy(buffer + size, string, length);
+			buffer[size + length] = '\0';
+			size += (uint32_t)length + 1;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	// An empty capture would read as a failure
+	return size > 0 ? size : 1;
+}
+
+#define LOG_FORMAT(type, output, remaining, spec, stars, starCount, arguments)				\
+	do {																					\
+		type value;																			\
+		memcpy(&value, arguments, sizeof(type));											\
+		arguments += sizeof(type);															\
+		if (starCount == 2)																	\
+			written = snprintf(output, remaining, spec, stars[0], stars[1], value);			\
+		else if (starCount == 1)															\
+			written = snprintf(output, remaining, spec, stars[0], value);					\
+		else																				\
+			written = snprintf(output, remaining, spec, value);								\
+	} while (0)
+
+// Replays the captured arguments one conversion at a time
+static void FormatDeferred(const char* fmt, const unsigned char* arguments, char* output, size_t outputSize)
 {
-	time_t now = time(NULL);
-	struct tm* t = localtime(&now);
-	static char timeString[9];
-	strftime(timeString, sizeof(timeString), "%H:%M:%S", t);
-	return timeString;
+	size_t length = 0;
+
+	for (const char* c = fmt; *c != '\0' && length + 1 < outputSize; c++)
+	{
+		if (*c != '%')
+		{
+			output[length++] = *c;
+			continue;
+		}
+
+		LogConversion conversion = ParseConversion(c);
+
+		char spec[32];
+		if (conversion.Length >= sizeof(spec))
+			break;
+		memcpy(spec, c, conversion.Length);
+		spec[conversion.Length] = '\0';
+		c += conversion.Length - 1;
+
+		int stars[2] = { 0, 0 };
+		for (uint32_t i = 0; i < conversion.StarCount; i++)
+		{
+			memcpy(&stars[i], arguments, sizeof(int));
+			arguments += sizeof(int);
+		}
+
+		char* target = output + length;
+		size_t remaining = outputSize - length;
+		uint32_t starCount = conversion.StarCount;
+		int written = 0;
+
+		switch (conversion.Type)
+		{
+		case LogArgumentType_Int: LOG_FORMAT(int, target, remaining, spec, stars, starCount, arguments); break;
+		case LogArgumentType_Long: LOG_FORMAT(long, target, remaining, spec, stars, starCount, arguments); break;
+		case LogArgumentType_LongLong: LOG_FORMAT(long long, target, remaining, spec, stars, starCount, arguments); break;
+		case LogArgumentType_Size: LOG_FORMAT(size_t, target, remaining, spec, stars, starCount, arguments); break;
+		case LogArgumentType_Double: LOG_FORMAT(double, target, remaining, spec, stars, starCount, arguments); break;
+		case LogArgumentType_LongDouble: LOG_FORMAT(long double, target, remaining, spec, stars, starCount, arguments); break;
+		case LogArgumentType_Pointer: LOG_FORMAT(void*, target, remaining, spec, stars, starCount, arguments); break;
+		case LogArgumentType_String:
+		{
+			const char* string = (const char*)arguments;
+			arguments += strlen(string) + 1;
+			if (starCount == 2)
+				written = snprintf(target, remaining, spec, stars[0], stars[1], string);
+			else if (starCount == 1)
+				written = snprintf(target, remaining, spec, stars[0], string);
+			else
+				written = snprintf(target, remaining, spec, string);
+			break;
+		}
+		case LogArgumentType_Percent:
+			written = snprintf(target, remaining, "%%");
+			break;
+		default:
+			// Rejected at capture
+			written = 0;
+			break;
+		}
+
+		if (written < 0)
+			break;
+		length += (size_t)written < remaining ? (size_t)written : remaining - 1;
+	}
+
+	output[length] = '\0';
 }
 
-void LogTrace(const char* fmt, ...)
+// Returns 0 if no record was ready
+static int WriteNextRecord()
+{
+	uint32_t position = s_DequeuePosition;
+	LogRecord* record = &s_Records[position & (LSH_LOG_QUEUE_CAPACITY - 1)];
+	if (AtomicLoad32(&record->Sequence) != position + 1)
+		return 0;
+
+	if (record->Format != NULL)
+	{
+		char message[LSH_LOG_MESSAGE_SIZE];
+		FormatDeferred(record->Format, (const unsigned char*)record->Message, message, sizeof(message));
+		WriteRecord(record->Level, record->Time, message);
+	}
+	else
+	{
+		WriteRecord(record->Level, record->Time, record->Message);
+	}
+
+	// Hands the slot back to the producers one lap later
+	AtomicStore32(&record->Sequence, position + LSH_LOG_QUEUE_CAPACITY);
+	AtomicStore32(&s_DequeuePosition, position + 1);
+
+	return 1;
+}
+
+static void WriterMain(void* userData)
+{
+	while (1)
+	{
+		while (WriteNextRecord())
+			;
+
+		uint32_t dropped = AtomicLoad32(&s_DroppedRecords);
+		if (dropped > 0)
+		{
+			AtomicAdd32(&s_DroppedRecords, (uint32_t)0 - dropped);
+			char message[64];
+			snprintf(message, sizeof(message), "Log queue was full, dropped %u records", dropped);
+			WriteRecord(LogLevel_Warn, time(NULL), message);
+		}
+
+		FlushOutput();
+
+		if (!AtomicLoad32(&s_WriterRunning))
+			break;
+
+		// Announce the sleep before the last look, a producer either sees it or its record is seen here
+		AtomicAdd32(&s_WriterSleeping, 1);
+		AtomicFence();
+		if (AtomicLoad32(&s_Records[s_DequeuePosition & (LSH_LOG_QUEUE_CAPACITY - 1)].Sequence) != s_DequeuePosition + 1 &&
+			AtomicLoad32(&s_WriterRunning))
+			WaitSemaphore(&s_RecordsAvailable);
+		AtomicAdd32(&s_WriterSleeping, (uint32_t)-1);
+	}
+
+	// Records that raced with the shutdown
+	while (WriteNextRecord())
+		;
+	FlushOutput();
+}
+
+static void LogMessage(LogLevel level, LogCategory category, const char* fmt, va_list args)
+{
+	if ((uint32_t)level < AtomicLoad32(&s_CategoryLevels[category]))
+		return;
+
+	AtomicAdd32(&s_ActiveProducers, 1);
+	if (!AtomicLoad32(&s_AcceptingRecords))
+	{
+		AtomicAdd32(&s_ActiveProducers, (uint32_t)-1);
+
+		// Only while ShutdownLog is stopping the writer, the output isn't shared with it
+		while (AtomicLoad32(&s_WriterRunning))
+			YieldThread();
+
+		char message[LSH_LOG_MESSAGE_SIZE];
+		vsnprintf(message, sizeof(message), fmt, args);
+		WriteRecord(level, time(NULL), message);
+		if (level >= LogLevel_Warn)
+			FlushOutput();
+		return;
+	}
+
+	LogRecord* record = NULL;
+	uint32_t position = AtomicLoad32(&s_EnqueuePosition);
+	while (1)
+	{
+		record = &s_Records[position & (LSH_LOG_QUEUE_CAPACITY - 1)];
+		int32_t difference = (int32_t)(AtomicLoad32(&record->Sequence) - position);
+
+		if (difference == 0)
+		{
+			if (AtomicCompareExchange32(&s_EnqueuePosition, position, position + 1))
+				break;
+			position = AtomicLoad32(&s_EnqueuePosition);
+		}
+		else if (difference < 0)
+		{
+			// Full, hot path traces give way but problems are never lost
+			if (level <= LogLevel_Info)
+			{
+				AtomicAdd32(&s_DroppedRecords, 1);
+				AtomicAdd32(&s_ActiveProducers, (uint32_t)-1);
+				return;
+			}
+			YieldThread();
+			position = AtomicLoad32(&s_EnqueuePosition);
+		}
+		else
+		{
+			position = AtomicLoad32(&s_EnqueuePosition);
+		}
+	}
+
+	record->Level = level;
+	record->Category = category;
+	record->Time = time(NULL);
+	record->Format = NULL;
+
+	va_list captured;
+	va_copy(captured, args);
+	if (AtomicLoad32(&s_DeferredFormatting))
+	{
+		record->ArgumentsSize = CaptureArguments(fmt, captured, (unsigned char*)record->Message, sizeof(record->Message));
+		if (record->ArgumentsSize > 0)
+			record->Format = fmt;
+	}
+	va_end(captured);
+
+	// Arguments too large to capture or with unsupported conversions are formatted right away
+	if (record->Format == NULL)
+		vsnprintf(record->Message, sizeof(record->Message), fmt, args);
+
+	AtomicStore32(&record->Sequence, position + 1);
+
+	AtomicFence();
+	if (AtomicLoad32(&s_WriterSleeping))
+		SignalSemaphore(&s_RecordsAvailable, 1);
+
+	AtomicAdd32(&s_ActiveProducers, (uint32_t)-1);
+}
+
+void InitLog()
+{
+	for (uint32_t i = 0; i < LSH_LOG_QUEUE_CAPACITY; i++)
+		s_Records[i].Sequence = i;
+	s_EnqueuePosition = 0;
+	s_DequeuePosition = 0;
+
+	MakeDirectory(s_LogDirectory);
+	RotateLogFile();
+	if (s_LogFile == NULL)
+		printf(YELLOW_STRING("Could not open %s, logging to the console only\n"), s_LogPath);
+
+	if (!InitSemaphore(&s_RecordsAvailable, 0))
+		return;
+
+	AtomicStore32(&s_WriterRunning, 1);
+	if (!StartThread(&s_WriterThread, WriterMain, NULL))
+	{
+		AtomicStore32(&s_WriterRunning, 0);
+		ShutdownSemaphore(&s_RecordsAvailable);
+		return;
+	}
+
+	AtomicStore32(&s_AcceptingRecords, 1);
+}
+
+void FlushLog()
+{
+	if (!AtomicLoad32(&s_WriterRunning))
+	{
+		FlushOutput();
+		return;
+	}
+
+	uint32_t target = AtomicLoad32(&s_EnqueuePosition);
+	SignalSemaphore(&s_RecordsAvailable, 1);
+	while ((int32_t)(AtomicLoad32(&s_DequeuePosition) - target) < 0)
+		YieldThread();
+}
+
+void ShutdownLog()
+{
+	if (!AtomicLoad32(&s_WriterRunning))
+		return;
+
+	// Producers already past the check may still be filling a slot, the writer keeps draining until they are done
+	AtomicStore32(&s_AcceptingRecords, 0);
+	AtomicFence();
+	while (AtomicLoad32(&s_ActiveProducers) != 0)
+		YieldThread();
+
+	AtomicStore32(&s_WriterRunning, 0);
+	SignalSemaphore(&s_RecordsAvailable, 1);
+	JoinThread(&s_WriterThread);
+	ShutdownSemaphore(&s_RecordsAvailable);
+
+	// Records published between the writer's last drain and its stop check
+	while (WriteNextRecord())
+		;
+	FlushOutput();
+
+	if (s_LogFile != NULL)
+	{
+		fclose(s_LogFile);
+		s_LogFile = NULL;
+	}
+}
+
+void SetLogLevel(LogCategory category, LogLevel level)
+{
+	AtomicStore32(&s_CategoryLevels[category], (uint32_t)level);
+}
+
+LogLevel GetLogLevel(LogCategory category)
+{
+	return (LogLevel)AtomicLoad32(&s_CategoryLevels[category]);
+}
+
+static int EqualsIgnoreCase(const char* a, const char* b, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		if (b[i] == '\0' || tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+			return 0;
+	}
+	return b[length] == '\0';
+}
+
+int SetLogLevelFromString(const char* setting)
+{
+	const char* separator = strchr(setting, '=');
+	const char* levelName = separator != NULL ? separator + 1 : setting;
+
+	int level = -1;
+	for (int i = 0; i <= LogLevel_Fatal; i++)
+	{
+		if (EqualsIgnoreCase(levelName, s_LevelNames[i], strlen(levelName)))
+			level = i;
+	}
+	if (level < 0)
+	{
+		LSH_WARN("Unknown log level in '%s'", setting);
+		return 0;
+	}
+
+	for (int i = 0; i < LogCategory_Count; i++)
+	{
+		if (separator == NULL || EqualsIgnoreCase(setting, s_CategoryNames[i], (size_t)(separator - setting)))
+		{
+			SetLogLevel((LogCategory)i, (LogLevel)level);
+			if (separator != NULL)
+				return 1;
+		}
+	}
+
+	if (separator != NULL)
+	{
+		LSH_WARN("Unknown log category in '%s'", setting);
+		return 0;
+	}
+
+	return 1;
+}
+
+void SetLogDeferredFormatting(int enable)
+{
+	AtomicStore32(&s_DeferredFormatting, enable ? 1 : 0);
+}
+
+void LogTrace(LogCategory category, const char* fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
-	printf("[%s] LostSheep: ", GetCurrentTimeString());
-	vprintf(fmt, args);
+	LogMessage(LogLevel_Trace, category, fmt, args);
 	va_end(args);
-	printf("\n");
 }
 
-void LogInfo(const char* fmt, ...)
+void LogInfo(LogCategory category, const char* fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
-	printf(GREEN_STRING("[%s] LostSheep: "), GetCurrentTimeString());
-
-	char formattedMessage[1024]; 
-	vsnprintf(formattedMessage, sizeof(formattedMessage), fmt, args);
-	printf(GREEN_STRING("%s\n"), formattedMessage);
-
+	LogMessage(LogLevel_Info, category, fmt, args);
 	va_end(args);
 }
 
-void LogWarn(const char* fmt, ...)
+void LogWarn(LogCategory category, const char* fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
-	printf(YELLOW_STRING("[%s] LostSheep: "), GetCurrentTimeString());
-
-	char formattedMessage[1024]; 
-	vsnprintf(formattedMessage, sizeof(formattedMessage), fmt, args);
-	printf(YELLOW_STRING("%s\n"), formattedMessage);
-
+	LogMessage(LogLevel_Warn, category, fmt, args);
 	va_end(args);
-	printf("\n");
 }
 
-void LogError(const char* fmt, ...)
+void LogError(LogCategory category, const char* fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
-	printf(RED_STRING("[%s] LostSheep: "), GetCurrentTimeString());
-
-	char formattedMessage[1024]; 
-	vsnprintf(formattedMessage, sizeof(formattedMessage), fmt, args);
-	printf(RED_STRING("%s\n"), formattedMessage);
-
+	LogMessage(LogLevel_Error, category, fmt, args);
 	va_end(args);
-	printf("\n");
 }
 
-void LogFatal(const char* fmt, ...)
+void LogFatal(LogCategory category, const char* fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
-	printf(RED_STRING("[%s] FATAL: "), GetCurrentTimeString());
-
-	char formattedMessage[1024]; 
-	vsnprintf(formattedMessage, sizeof(formattedMessage), fmt, args);
-	printf(RED_STRING("%s\n"), formattedMessage);
-
+	LogMessage(LogLevel_Fatal, category, fmt, args);
 	va_end(args);
-	printf("\n");
+
+	// The process may not get much further
+	FlushLog();
 }
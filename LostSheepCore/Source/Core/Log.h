@@ -1,15 +1,110 @@
 #pragma once
 
+#include <stdint.h>
+
 #define TO_STRING(string) #string
 
-void LogTrace(const char* fmt, ...);
-void LogInfo(const char* fmt, ...);
-void LogWarn(const char* fmt, ...);
-void LogError(const char* fmt, ...);
-void LogFatal(const char* fmt, ...);
-
-#define LSH_TRACE(...)	LogTrace(__VA_ARGS__)
-#define LSH_INFO(...)	LogInfo(__VA_ARGS__)
-#define LSH_WARN(...)	LogWarn(__VA_ARGS__)
-#define LSH_ERROR(...)	LogError(__VA_ARGS__)
-#define LSH_FATAL(...)	LogFatal(__VA_ARGS__)
+// Records that fit in the log queue, producers never block on console or file output
+#define LSH_LOG_QUEUE_CAPACITY 2048
+#define LSH_LOG_MESSAGE_SIZE 1024
+
+// Log file is rotated when it grows past this, the last few runs are kept next to it
+#define LSH_LOG_FILE_MAX_SIZE (4 * 1024 * 1024)
+#define LSH_LOG_FILE_BACKUPS 3
+
+// Numeric so the preprocessor can compare them, match LogLevel
+#define LSH_LOG_LEVEL_TRACE 0
+#define LSH_LOG_LEVEL_INFO 1
+#define LSH_LOG_LEVEL_WARN 2
+#define LSH_LOG_LEVEL_ERROR 3
+#define LSH_LOG_LEVEL_FATAL 4
+
+// Calls below this level are compiled out, including their arguments
+#ifndef LSH_LOG_MIN_LEVEL
+	#if defined(LSH_DIST)
+		#define LSH_LOG_MIN_LEVEL LSH_LOG_LEVEL_WARN
+	#elif defined(LSH_RELEASE)
+		#define LSH_LOG_MIN_LEVEL LSH_LOG_LEVEL_INFO
+	#else
+		#define LSH_LOG_MIN_LEVEL LSH_LOG_LEVEL_TRACE
+	#endif
+#endif
+
+typedef enum LogLevel
+{
+	LogLevel_Trace = LSH_LOG_LEVEL_TRACE,
+	LogLevel_Info = LSH_LOG_LEVEL_INFO,
+	LogLevel_Warn = LSH_LOG_LEVEL_WARN,
+	LogLevel_Error = LSH_LOG_LEVEL_ERROR,
+	LogLevel_Fatal = LSH_LOG_LEVEL_FATAL
+} LogLevel;
+
+typedef enum LogCategory
+{
+	LogCategory_Core,
+	LogCategory_Event,
+	LogCategory_Renderer,
+	LogCategory_Text,
+	LogCategory_UI,
+	LogCategory_Assets,
+
+	LogCategory_Count
+} LogCategory;
+
+// A source file picks its category by defining this before its includes
+#ifndef LSH_LOG_CATEGORY
+#define LSH_LOG_CATEGORY LogCategory_Core
+#endif
+
+// Starts the background writer, logging before this or after ShutdownLog writes synchronously to the console
+void InitLog();
+
+// Blocks until every queued record has been written
+void FlushLog();
+
+// Writes out every queued record, stops the writer and closes the log file
+void ShutdownLog();
+
+// Records below the level are dropped before they are formatted
+void SetLogLevel(LogCategory category, LogLevel level);
+
+LogLevel GetLogLevel(LogCategory category);
+
+// Parses "Category=Level" or "Level" for every category, names are case insensitive
+int SetLogLevelFromString(const char* setting);
+
+// Producers only capture the format string pointer and the raw arguments, the writer formats them.
+// Format strings must outlive the record, string arguments are copied
+void SetLogDeferredFormatting(int enable);
+
+void LogTrace(LogCategory category, const char* fmt, ...);
+void LogInfo(LogCategory category, const char* fmt, ...);
+void LogWarn(LogCategory category, const char* fmt, ...);
+void LogError(LogCategory category, const char* fmt, ...);
+void LogFatal(LogCategory category, const char* fmt, ...);
+
+#if LSH_LOG_MIN_LEVEL <= LSH_LOG_LEVEL_TRACE
+#define LSH_TRACE(...)	LogTrace(LSH_LOG_CATEGORY, __VA_ARGS__)
+#else
+#define LSH_TRACE(...)	((void)0)
+#endif
+
+#if LSH_LOG_MIN_LEVEL <= LSH_LOG_LEVEL_INFO
+#define LSH_INFO(...)	LogInfo(LSH_LOG_CATEGORY, __VA_ARGS__)
+#else
+#define LSH_INFO(...)	((void)0)
+#endif
+
+#if LSH_LOG_MIN_LEVEL <= LSH_LOG_LEVEL_WARN
+#define LSH_WARN(...)	LogWarn(LSH_LOG_CATEGORY, __VA_ARGS__)
+#else
+#define LSH_WARN(...)	((void)0)
+#endif
+
+#if LSH_LOG_MIN_LEVEL <= LSH_LOG_LEVEL_ERROR
+#define LSH_ERROR(...)	LogError(LSH_LOG_CATEGORY, __VA_ARGS__)
+#else
+#define LSH_ERROR(...)	((void)0)
+#endif
+
+#define LSH_FATAL(...)	LogFatal(LSH_LOG_CATEGORY, __VA_ARGS__)
@@ -0,0 +1,172 @@
+#include "Memory.h"
+
+#include "Core/Atomic.h"
+#include "Core/Log.h"
+
+#include <string.h>
+
+static const char* s_MemoryTagNames[MemoryTag_Count] = {
+	"Core",
+	"Renderer",
+	"Text",
+	"UI",
+	"Event",
+	"Assets"
+};
+
+static MemoryTagStats s_MemoryStats[MemoryTag_Count];
+
+char* DuplicateString(const char* string)
+{
+	size_t length = strlen(string) + 1;
+	char* result = (char*)malloc(length);
+	if (result != NULL)
+		memcpy(result, string, length);
+	return result;
+}
+
+const char* GetMemoryTagName(MemoryTag tag)
+{
+	return (uint32_t)tag < MemoryTag_Count ? s_MemoryTagNames[tag] : "Unknown";
+}
+
+const MemoryTagStats* GetMemoryTagStats(MemoryTag tag)
+{
+	return &s_MemoryStats[tag];
+}
+
+#ifdef LSH_DIST
+
+uint32_t ReportMemoryLeaks()
+{
+	return 0;
+}
+
+#else
+
+// Keeps the user pointer 16 byte aligned
+typedef struct AllocationHeader
+{
+	uint64_t Size;
+	uint32_t Tag;
+	uint32_t Padding;
+} AllocationHeader;
+
+static void CountAllocation(MemoryTag tag, size_t size)
+{
+	MemoryTagStats* stats = &s_MemoryStats[tag];
+
+	uint32_t live = AtomicAdd32(&stats->LiveBytes, (uint32_t)size) + (uint32_t)size;
+	AtomicAdd32(&stats->LiveAllocations, 1);
+	AtomicAdd32(&stats->TotalAllocations, 1);
+
+	uint32_t peak = AtomicLoad32(&stats->PeakBytes);
+	while (live > peak && !AtomicCompareExchange32(&stats->PeakBytes, peak, live))
+		peak = AtomicLoad32(&stats->PeakBytes);
+}
+
+static void CountFree(MemoryTag tag, size_t size)
+{
+	MemoryTagStats* stats = &s_MemoryStats[tag];
+
+	AtomicAdd32(&stats->LiveBytes, (uint32_t)0 - (uint32_t)size);
+	AtomicAdd32(&stats->LiveAllocations, (uint32_t)-1);
+}
+
+static AllocationHeader* GetHeader(void* memory)
+{
+	return (AllocationHeader*)memory - 1;
+}
+
+void* AllocateTracked(size_t size, MemoryTag tag)
+{
+	AllocationHeader* header = (AllocationHeader*)malloc(sizeof(AllocationHeader) + size);
+	if (header == NULL)
+		return NULL;
+
+	header->Size = size;
+	header->Tag = (uint32_t)tag;
+	CountAllocation(tag, size);
+
+	return header + 1;
+}
+
+void* AllocateZeroedTracked(size_t count, size_t size, MemoryTag tag)
+{
+	if (size != 0 && count > ((size_t)-1 - sizeof(AllocationHeader)) / size)
+		return NULL;
+
+	void* memory = AllocateTracked(count * size, tag);
+	if (memory != NULL)
+		memset(memory, 0, count * size);
+	return memory;
+}
+
+void* ReallocateTracked(void* memory, size_t size, MemoryTag tag)
+{
+	if (memory == NULL)
+		return AllocateTracked(size, tag);
+
+	AllocationHeader* header = GetHeader(memory);
+	size_t oldSize = (size_t)header->Size;
+	MemoryTag oldTag = (MemoryTag)header->Tag;
+
+	AllocationHeader* resized = (AllocationHeader*)realloc(header, sizeof(AllocationHeader) + size);
+	if (resized == NULL)
+		return NULL;
+
+	CountFree(oldTag, oldSize);
+	resized->Size = size;
+	resized->Tag = (uint32_t)tag;
+	CountAllocation(tag, size);
+
+	return resized + 1;
+}
+
+char* DuplicateStringTracked(const char* string, MemoryTag tag)
+{
+	size_t length = strlen(string) + 1;
+	char* result = (char*)AllocateTracked(length, tag);
+	if (result != NULL)
+		memcpy(result, string, length);
+	return result;
+}
+
+void FreeTracked(void* memory)
+{
+	if (memory == NULL)
+		return;
+
+	AllocationHeader* header = GetHeader(memory);
+	CountFree((MemoryTag)header->Tag, (size_t)header->Size);
+	free(header);
+}
+
+uint32_t ReportMemoryLeaks()
+{
+	uint32_t leakedAllocations = 0;
+
+	for (uint32_t i = 0; i < MemoryTag_Count; i++)
+	{
+		const MemoryTagStats* stats = &s_MemoryStats[i];
+		uint32_t liveAllocations = AtomicLoad32((volatile uint32_t*)&stats->LiveAllocations);
+
+		if (liveAllocations > 0)
+		{
+			LSH_WARN("Memory leak in %s: %u bytes in %u allocations (peak %u bytes)",
+				s_MemoryTagNames[i], AtomicLoad32((volatile uint32_t*)&stats->LiveBytes), liveAllocations, stats->PeakBytes);
+			leakedAllocations += liveAllocations;
+		}
+		else if (stats->TotalAllocations > 0)
+		{
+			LSH_TRACE("Memory %s: peak %u bytes over %u allocations", s_MemoryTagNames[i], stats->PeakBytes, stats->TotalAllocations);
+		}
+	}
+
+	if (leakedAllocations == 0)
+		LSH_TRACE("No memory leaks");
+
+	return leakedAllocations;
+}
+
+#endif
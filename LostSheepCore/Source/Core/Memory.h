@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Every heap allocation goes through these with the subsystem that owns it.
+// Tracking is compiled out in Dist, the macros are plain CRT calls there
+typedef enum MemoryTag
+{
+	MemoryTag_Core,
+	MemoryTag_Renderer,
+	MemoryTag_Text,
+	MemoryTag_UI,
+	MemoryTag_Event,
+	MemoryTag_Assets,
+
+	MemoryTag_Count
+} MemoryTag;
+
+typedef struct MemoryTagStats
+{
+	volatile uint32_t LiveBytes;
+	volatile uint32_t PeakBytes;
+	volatile uint32_t LiveAllocations;
+	volatile uint32_t TotalAllocations;
+} MemoryTagStats;
+
+#ifdef LSH_DIST
+
+#define LSH_MALLOC(size, tag) malloc(size)
+#define LSH_CALLOC(count, size, tag) calloc(count, size)
+#define LSH_REALLOC(memory, size, tag) realloc(memory, size)
+#define LSH_STRDUP(string, tag) DuplicateString(string)
+#define LSH_FREE(memory) free(memory)
+
+#else
+
+#define LSH_MALLOC(size, tag) AllocateTracked(size, tag)
+#define LSH_CALLOC(count, size, tag) AllocateZeroedTracked(count, size, tag)
+#define LSH_REALLOC(memory, size, tag) ReallocateTracked(memory, size, tag)
+#define LSH_STRDUP(string, tag) DuplicateStringTracked(string, tag)
+#define LSH_FREE(memory) FreeTracked(memory)
+
+void* AllocateTracked(size_t size, MemoryTag tag);
+void* AllocateZeroedTracked(size_t count, size_t size, MemoryTag tag);
+void* ReallocateTracked(void* memory, size_t size, MemoryTag tag);
+char* DuplicateStringTracked(const char* string, MemoryTag tag);
+void FreeTracked(void* memory);
+
+#endif
+
+char* DuplicateString(const char* string);
+
+const char* GetMemoryTagName(MemoryTag tag);
+
+// All zero in Dist
+const MemoryTagStats* GetMemoryTagStats(MemoryTag tag);
+
+// Logs the tags that still own memory, returns the number of live allocations
+uint32_t ReportMemoryLeaks();
@@ -0,0 +1,290 @@
+#include "Profiler.h"
+
+#include "Core/Atomic.h"
+#include "Core/Clock.h"
+#include "Core/Log.h"
+#include "Core/Memory.h"
+#include "Core/Thread.h"
+
+#include <stdio.h>
+
+#if defined(LSH_PROFILE_ENABLED)
+
+// End events have no name
+typedef struct ProfileEvent
+{
+	const char* Name;
+	uint64_t Ticks;
+} ProfileEvent;
+
+// Written only by its own thread, Count is published so the exporter can read up to it
+typedef struct ProfileThreadBuffer
+{
+	ProfileEvent* Events;
+	volatile uint32_t Count;
+	uint32_t Session; // Buffers of an older session are reset by their thread on its next event
+	uint32_t Depth; // Recorded scopes still open
+	uint32_t SkippedDepth; // Open scopes that didn't fit, always the innermost ones
+	uint32_t Dropped;
+	const char* Name;
+} ProfileThreadBuffer;
+
+static ProfileThreadBuffer s_Buffers[LSH_PROFILE_MAX_THREADS];
+static volatile uint32_t s_BufferCount = 0;
+
+static LSH_THREAD_LOCAL ProfileThreadBuffer* s_ThreadBuffer = NULL;
+static LSH_THREAD_LOCAL int s_ThreadUnregistered = 0;
+
+static volatile uint32_t s_Active = 0;
+static volatile uint32_t s_Session = 0;
+static uint64_t s_SessionStart = 0;
+static char s_SessionPath[512];
+
+static ProfileThreadBuffer* GetThreadBuffer()
+{
+	if (s_ThreadBuffer != NULL || s_ThreadUnregistered)
+		return s_ThreadBuffer;
+
+	uint32_t index = AtomicAdd32(&s_BufferCount, 1);
+	if (index >= LSH_PROFILE_MAX_THREADS)
+	{
+		// Threads past the limit aren't profiled
+		s_ThreadUnregistered = 1;
+		return NULL;
+	}
+
+	ProfileThreadBuffer* buffer = &s_Buffers[index];
+	buffer->Events = (ProfileEvent*)LSH_MALLOC(sizeof(ProfileEvent) * LSH_PROFILE_EVENTS_PER_THREAD, MemoryTag_Core);
+	if (buffer->Events == NULL)
+	{
+		s_ThreadUnregistered = 1;
+		return NULL;
+	}
+
+	s_ThreadBuffer = buffer;
+	return buffer;
+}
+
+static ProfileThreadBuffer* GetSessionBuffer()
+{
+	ProfileThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer == NULL)
+		return NULL;
+
+	uint32_t session = AtomicLoad32(&s_Session);
+	if (buffer->Session != session)
+	{
+		AtomicStore32(&buffer->Count, 0);
+		buffer->Session = session;
+		buffer->Depth = 0;
+		buffer->SkippedDepth = 0;
+		buffer->Dropped = 0;
+	}
+
+	return buffer;
+}
+
+void BeginProfileScope(const char* name)
+{
+	if (!AtomicLoad32(&s_Active))
+		return;
+
+	ProfileThreadBuffer* buffer = GetSessionBuffer();
+	if (buffer == NULL)
+		return;
+
+	// Room is kept for the end of every open scope so the trace stays balanced
+	uint32_t count = buffer->Count;
+	if (buffer->SkippedDepth > 0 || count + buffer->Depth + 2 > LSH_PROFILE_EVENTS_PER_THREAD)
+	{
+		buffer->SkippedDepth++;
+		buffer->Dropped++;
+		return;
+	}
+
+	buffer->Events[count].Name = name;
+	buffer->Events[count].Ticks = GetTicksClock();
+	buffer->Depth++;
+	AtomicStore32(&buffer->Count, count + 1);
+}
+
+void EndProfileScope()
+{
+	ProfileThreadBuffer* buffer = s_ThreadBuffer;
+	if (buffer == NULL || buffer->Session != AtomicLoad32(&s_Session))
+		return;
+
+	if (buffer->SkippedDepth > 0)
+	{
+		buffer->SkippedDepth--;
+		return;
+	}
+
+	// Scopes opened before the session started
+	if (buffer->Depth == 0)
+		return;
+
+	uint32_t count = buffer->Count;
+	buffer->Events[count].Name = NULL;
+	buffer->Events[count].Ticks = GetTicksClock();
+	buffer->Depth--;
+	AtomicStore32(&buffer->Count, count + 1);
+}
+
+void SetProfileThreadName(const char* name)
+{
+	ProfileThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer != NULL)
+		buffer->Name = name;
+}
+
+int BeginProfileSession(const char* path)
+{
+	if (AtomicLoad32(&s_Active))
+	{
+		LSH_WARN("Profile session already running, %s is not started", path);
+		return 0;
+	}
+
+	snprintf(s_SessionPath, sizeof(s_SessionPath), "%s", path);
+	s_SessionStart = GetTicksClock();
+
+	AtomicAdd32(&s_Session, 1);
+	AtomicStore32(&s_Active, 1);
+
+	LSH_INFO("Profiling to %s", path);
+	return 1;
+}
+
+static void WriteEscapedName(FILE* file, const char* name)
+{
+	for (const char* c = name; *c != '\0'; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			fputc('\\', file);
+		fputc(*c, file);
+	}
+}
+
+static double TicksToMicroseconds(uint64_t ticks)
+{
+	return TicksToMillisecondsClock(ticks - s_SessionStart) * 1000.0;
+}
+
+void EndProfileSession()
+{
+	if (!AtomicLoad32(&s_Active))
+		return;
+
+	AtomicStore32(&s_Active, 0);
+
+	FILE* file = fopen(s_SessionPath, "w");
+	if (file == NULL)
+	{
+		LSH_ERROR("Failed to open %s, profile is not written", s_SessionPath);
+		return;
+	}
+
+	uint32_t session = AtomicLoad32(&s_Session);
+	uint32_t bufferCount = AtomicLoad32(&s_BufferCount);
+	if (bufferCount > LSH_PROFILE_MAX_THREADS)
+		bufferCount = LSH_PROFILE_MAX_THREADS;
+
+	uint32_t eventCount = 0;
+	uint32_t dropped = 0;
+	int first = 1;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (uint32_t i = 0; i < bufferCount; i++)
+	{
+		ProfileThreadBuffer* buffer = &s_Buffers[i];
+		uint32_t count = AtomicLoad32(&buffer->Count);
+		if (buffer->Session != session)
+			count = 0;
+
+		if (buffer->Name != NULL)
+		{
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", first ? "" : ",\n", i);
+			WriteEscapedName(file, buffer->Name);
+			fprintf(file, "\"}}");
+			first = 0;
+		}
+
+		for (uint32_t e = 0; e < count; e++)
+		{
+			const ProfileEvent* event = &buffer->Events[e];
+			if (event->Name != NULL)
+			{
+				fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+				WriteEscapedName(file, event->Name);
+				fprintf(file, "\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", TicksToMicroseconds(event->Ticks), i);
+			}
+			else
+			{
+				fprintf(file, "%s{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", first ? "" : ",\n", TicksToMicroseconds(event->Ticks), i);
+			}
+			first = 0;
+		}
+
+		eventCount += count;
+		if (buffer->Session == session)
+			dropped += buffer->Dropped;
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	if (dropped > 0)
+		LSH_WARN("Profile buffers were full, dropped %u scopes", dropped);
+	LSH_INFO("Profile written to %s: %u events", s_SessionPath, eventCount);
+}
+
+int IsProfiling()
+{
+	return (int)AtomicLoad32(&s_Active);
+}
+
+void ShutdownProfiler()
+{
+	EndProfileSession();
+
+	uint32_t bufferCount = AtomicLoad32(&s_BufferCount);
+	if (bufferCount > LSH_PROFILE_MAX_THREADS)
+		bufferCount = LSH_PROFILE_MAX_THREADS;
+
+	for (uint32_t i = 0; i < bufferCount; i++)
+	{
+		LSH_FREE(s_Buffers[i].Events);
+		s_Buffers[i].Events = NULL;
+	}
+
+	// Only this thread's pointer can be reset, the others must have stopped by now
+	s_ThreadBuffer = NULL;
+	s_ThreadUnregistered = 1;
+}
+
+#else
+
+int BeginProfileSession(const char* path)
+{
+	LSH_WARN("Profiling is compiled out of this build, %s is not written", path);
+	return 0;
+}
+
+void EndProfileSession() {}
+
+int IsProfiling()
+{
+	return 0;
+}
+
+void SetProfileThreadName(const char* name) {}
+
+void BeginProfileScope(const char* name) {}
+
+void EndProfileScope() {}
+
+void ShutdownProfiler() {}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+// Instrumentation is compiled out of Dist builds, session calls become no-ops there
+#if !defined(LSH_DIST)
+#define LSH_PROFILE_ENABLED
+#endif
+
+#define LSH_PROFILE_MAX_THREADS 32
+// Scopes past this are dropped, EndProfileSession warns with the dropped count
+#define LSH_PROFILE_EVENTS_PER_THREAD (64 * 1024)
+
+#if defined(LSH_PROFILE_ENABLED)
+
+// Every exit of the profiled code needs its LSH_PROFILE_END, profile passes rather than per item calls
+#define LSH_PROFILE_BEGIN(name) BeginProfileScope(name)
+#define LSH_PROFILE_END() EndProfileScope()
+
+#else
+
+#define LSH_PROFILE_BEGIN(name) ((void)0)
+#define LSH_PROFILE_END() ((void)0)
+
+#endif
+
+// Events are recorded between these two, the trace is written as Chrome trace JSON (chrome://tracing, Perfetto)
+int BeginProfileSession(const char* path);
+
+void EndProfileSession();
+
+int IsProfiling();
+
+// Shown as the thread's name in the trace, the string must outlive the session
+void SetProfileThreadName(const char* name);
+
+// Names must outlive the session, string literals and __func__ do
+void BeginProfileScope(const char* name);
+
+void EndProfileScope();
+
+// Frees the per-thread buffers, every profiled thread must have stopped
+void ShutdownProfiler();
@@ -0,0 +1,197 @@
+#include "Thread.h"
+
+#include "Core/Log.h"
+#include "Core/Memory.h"
+
+#ifdef LSH_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+#ifdef LSH_PLATFORM_WINDOWS
+static unsigned __stdcall ThreadEntry(void* arg)
+{
+	Thread* thread = (Thread*)arg;
+	thread->Function(thread->UserData);
+	return 0;
+}
+#else
+static void* ThreadEntry(void* arg)
+{
+	Thread* thread = (Thread*)arg;
+	thread->Function(thread->UserData);
+	return NULL;
+}
+#endif
+
+int StartThread(Thread* thread, ThreadFn function, void* userData)
+{
+	thread->Function = function;
+	thread->UserData = userData;
+
+#ifdef LSH_PLATFORM_WINDOWS
+	thread->Handle = _beginthreadex(NULL, 0, ThreadEntry, thread, 0, NULL);
+	if (thread->Handle == 0)
+	{
+		LSH_ERROR("Failed to start thread");
+		return 0;
+	}
+#else
+	pthread_t handle;
+	if (pthread_create(&handle, NULL, ThreadEntry, thread) != 0)
+	{
+		LSH_ERROR("Failed to start thread");
+		thread->Handle = 0;
+		return 0;
+	}
+	thread->Handle = (uintptr_t)handle;
+#endif
+
+	return 1;
+}
+
+void JoinThread(Thread* thread)
+{
+	if (thread->Handle == 0)
+		return;
+
+#ifdef LSH_PLATFORM_WINDOWS
+	WaitForSingleObject((HANDLE)thread->Handle, INFINITE);
+	CloseHandle((HANDLE)thread->Handle);
+#else
+	pthread_join((pthread_t)thread->Handle, NULL);
+#endif
+
+	thread->Handle = 0;
+}
+
+void SleepThread(uint32_t milliseconds)
+{
+#ifdef LSH_PLATFORM_WINDOWS
+	Sleep(milliseconds);
+#else
+	struct timespec duration;
+	duration.tv_sec = milliseconds / 1000;
+	duration.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+	nanosleep(&duration, NULL);
+#endif
+}
+
+void YieldThread()
+{
+#ifdef LSH_PLATFORM_WINDOWS
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+uint32_t GetProcessorCountThread()
+{
+#ifdef LSH_PLATFORM_WINDOWS
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (uint32_t)info.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint32_t)count : 1;
+#endif
+}
+
+int InitSemaphore(Semaphore* semaphore, uint32_t initialCount)
+{
+#ifdef LSH_PLATFORM_WINDOWS
+	HANDLE handle = CreateSemaphoreA(NULL, (LONG)initialCount, 0x7fffffff, NULL);
+	if (handle == NULL)
+	{
+		LSH_ERROR("Failed to create semaphore");
+		semaphore->Handle = 0;
+		return 0;
+	}
+	semaphore->Handle = (uintptr_t)handle;
+#else
+	sem_t* handle = (sem_t*)LSH_MALLOC(sizeof(sem_t), MemoryTag_Core);
+	if (handle == NULL || sem_init(handle, 0, initialCount) != 0)
+	{
+		LSH_ERROR("Failed to create semaphore");
+		LSH_FREE(handle);
+		semaphore->Handle = 0;
+		return 0;
+	}
+	semaphore->Handle = (uintptr_t)handle;
+#endif
+
+	return 1;
+}
+
+void SignalSemaphore(Semaphore* semaphore, uint32_t count)
+{
+	if (count == 0)
+		return;
+
+#ifdef LSH_PLATFORM_WINDOWS
+	ReleaseSemaphore((HANDLE)semaphore->Handle, (LONG)count, NULL);
+#else
+	for (uint32_t i = 0; i < count; i++)
+		sem_post((sem_t*)semaphore->Handle);
+#endif
+}
+
+void WaitSemaphore(Semaphore* semaphore)
+{
+#ifdef LSH_PLATFORM_WINDOWS
+	WaitForSingleObject((HANDLE)semaphore->Handle, INFINITE);
+#else
+	// Interrupted waits are retried
+	while (sem_wait((sem_t*)semaphore->Handle) != 0)
+		;
+#endif
+}
+
+int WaitSemaphoreTimeout(Semaphore* semaphore, uint32_t milliseconds)
+{
+#ifdef LSH_PLATFORM_WINDOWS
+	return WaitForSingleObject((HANDLE)semaphore->Handle, milliseconds) == WAIT_OBJECT_0;
+#else
+	// sem_timedwait takes an absolute time on the realtime clock
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += milliseconds / 1000;
+	deadline.tv_nsec += (long)(milliseconds % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	while (sem_timedwait((sem_t*)semaphore->Handle, &deadline) != 0)
+	{
+		if (errno != EINTR)
+			return 0;
+	}
+	return 1;
+#endif
+}
+
+void ShutdownSemaphore(Semaphore* semaphore)
+{
+	if (semaphore->Handle == 0)
+		return;
+
+#ifdef LSH_PLATFORM_WINDOWS
+	CloseHandle((HANDLE)semaphore->Handle);
+#else
+	sem_destroy((sem_t*)semaphore->Handle);
+	LSH_FREE((sem_t*)semaphore->Handle);
+#endif
+
+	semaphore->Handle = 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#define LSH_THREAD_LOCAL __declspec(thread)
+#else
+#define LSH_THREAD_LOCAL __thread
+#endif
+
+typedef void (*ThreadFn)(void* userData);
+
+typedef struct Thread
+{
+	uintptr_t Handle;
+	ThreadFn Function;
+	void* UserData;
+} Thread;
+
+// Counting semaphore, blocked threads sleep in the kernel
+typedef struct Semaphore
+{
+	uintptr_t Handle;
+} Semaphore;
+
+// The Thread must outlive the started thread, it is passed to the entry trampoline
+int StartThread(Thread* thread, ThreadFn function, void* userData);
+
+void JoinThread(Thread* thread);
+
+void SleepThread(uint32_t milliseconds);
+
+// Gives up the rest of the time slice
+void YieldThread();
+
+// Logical cores available to the process
+uint32_t GetProcessorCountThread();
+
+int InitSemaphore(Semaphore* semaphore, uint32_t initialCount);
+
+void SignalSemaphore(Semaphore* semaphore, uint32_t count);
+
+void WaitSemaphore(Semaphore* semaphore);
+
+// Returns 0 if the timeout passed before the semaphore was signaled
+int WaitSemaphoreTimeout(Semaphore* semaphore, uint32_t milliseconds);
+
+void ShutdownSemaphore(Semaphore* semaphore);
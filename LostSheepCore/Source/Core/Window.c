@@ -1,7 +1,11 @@
 #include "Window.h"
 
+#include "Core/Atomic.h"
+#include "Core/Channel.h"
 #include "Core/Log.h"
+#include "Core/Thread.h"
 #include "Event/Event.h"
+#include "Event/EventQueue.h"
 #include "Renderer/Renderer.h"
 #include "UI/UI.h"
 
@@ -11,14 +15,131 @@
 #define GLFW_INCLUDE_NONE
 #include "GLFW/glfw3.h"
 
-#include "cglm/cglm.h"
-
 #include <stdlib.h>
+#include <string.h>
 
 static GLFWwindow* s_WindowHandle;
 static WindowData s_WindowData;
 
-static float s_LastFrameTime = 0.0f;
+static ModalFrameCallbackfn s_ModalFrameCallback = NULL;
+
+// Polling that doesn't return for this long in seconds is taken to be stuck in a modal resize or move loop
+#define LSH_WINDOW_MODAL_LOOP_THRESHOLD 0.1
+
+// Time the current glfwPollEvents or glfwWaitEvents call began handling events, negative outside of them.
+// A wait starts the clock at its first refresh, the time spent idle before it doesn't count
+static double s_PumpingSince = -1.0;
+
+// Bits of a float, written by the main thread callback and read by the render thread
+static volatile uint32_t s_ContentScaleBits = 0x3F800000u; // 1.0f
+
+// Render thread mode, see BeginThreadedWindow
+#define LSH_WINDOW_EVENT_CHANNEL_CAPACITY 1024
+#define LSH_WINDOW_REQUEST_CHANNEL_CAPACITY 64
+
+typedef enum WindowRequestType
+{
+	WindowRequestType_SetPosition,
+	WindowRequestType_Minimize,
+	WindowRequestType_MinMax
+} WindowRequestType;
+
+// Window changes asked for by the render thread, applied on the main thread
+typedef struct WindowRequest
+{
+	WindowRequestType Type;
+	int X;
+	int Y;
+} WindowRequest;
+
+static int s_IsThreaded = 0;
+static Channel s_EventChannel;
+static Channel s_RequestChannel;
+static uint32_t s_DroppedEventCount = 0;
+
+// Signaled when an event is pushed while the render thread is idle in WaitEventsWindow
+static Semaphore s_EventsAvailable;
+static volatile uint32_t s_RenderThreadWaiting = 0;
+
+// Kept up to date by the position callback, glfwGetWindowPos is main thread only
+static volatile uint32_t s_WindowPositionX = 0;
+static volatile uint32_t s_WindowPositionY = 0;
+
+static void InitWindowEvent(Event* event, EventType type, uint32_t size)
+{
+	InitEvent(event, type, size);
+	event->Timestamp = glfwGetTime();
+}
+
+static void SubmitEvent(const Event* event)
+{
+	if (!s_IsThreaded)
+	{
+		PushEvent(event);
+		return;
+	}
+
+	if (!TryPushChannel(&s_EventChannel, event))
+	{
+		if (s_DroppedEventCount == 0)
+			LSH_WARN("Window event channel is full, dropping events");
+		s_DroppedEventCount++;
+		return;
+	}
+
+	// Either the waiter sees the event or it has announced the wait and is signaled here
+	AtomicFence();
+	if (AtomicLoad32(&s_RenderThreadWaiting))
+		SignalSemaphore(&s_EventsAvailable, 1);
+}
+
+static void StoreContentScale(float scale)
+{
+	uint32_t bits;
+	memcpy(&bits, &scale, sizeof(bits));
+	AtomicStore32(&s_ContentScaleBits, bits);
+}
+
+static void PostWindowRequest(WindowRequestType type, int x, int y)
+{
+	WindowRequest request = { type, x, y };
+	if (!TryPushChannel(&s_RequestChannel, &request))
+	{
+		LSH_WARN("Window request channel is full, dropping request %d", (int)type);
+		return;
+	}
+
+	// The main thread is blocked in glfwWaitEvents
+	glfwPostEmptyEvent();
+}
+
+static void ProcessWindowRequests()
+{
+	WindowRequest request;
+	while (TryPopChannel(&s_RequestChannel, &request))
+	{
+		switch (request.Type)
+		{
+		case WindowRequestType_SetPosition:
+			glfwSetWindowPos(s_WindowHandle, request.X, request.Y);
+			break;
+		case WindowRequestType_Minimize:
+			glfwIconifyWindow(s_WindowHandle);
+			break;
+		case WindowRequestType_MinMax:
+			if (glfwGetWindowAttrib(s_WindowHandle, GLFW_MAXIMIZED))
+				glfwRestoreWindow(s_WindowHandle);
+			else
+				glfwMaximizeWindow(s_WindowHandle);
+			break;
+		}
+	}
+}
+
+static void WindowContentScaleCallback(GLFWwindow* window, float xScale, float yScale)
+{
+	StoreContentScale(xScale);
+}
 
 int InitWindow()
 {
@@ -32,8 +153,6 @@ int InitWindow()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-	glfwSwapInterval(1);
-
 	LSH_TRACE("GLFW initialized");
 
 	return 1;
@@ -47,6 +166,8 @@ void RegisterCallbacks(GLFWwindow* window)
 
 	glfwSetWindowSizeCallback(window, WindowResizeCallback);
 
+	glfwSetFramebufferSizeCallback(window, FramebufferResizeCallback);
+
 	glfwSetWindowCloseCallback(window, WindowCloseCallback);
 
 	glfwSetWindowPosCallback(window, WindowPositionCallback);
@@ -60,6 +181,8 @@ void RegisterCallbacks(GLFWwindow* window)
 	glfwSetCursorPosCallback(window, WindowCursorPositionCallback);
 
 	glfwSetScrollCallback(window, WindowScrollCallback);
+
+	glfwSetWindowContentScaleCallback(window, WindowContentScaleCallback);
 }
 
 int CreateWindow(const char* title, int width, int height)
@@ -86,12 +209,28 @@ int CreateWindow(const char* title, int width, int height)
 	glfwMakeContextCurrent(s_WindowHandle);
 	gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 
+	// Swap interval applies to the current context, the frame pacer may change it later
+	glfwSwapInterval(1);
+
+	glfwGetFramebufferSize(s_WindowHandle, &s_WindowData.FramebufferWidth, &s_WindowData.FramebufferHeight);
+
 	int monitorHeight = 0;
 	int monitorWidth = 0;
 	glfwGetMonitorPhysicalSize(glfwGetPrimaryMonitor(), &monitorWidth, &monitorHeight);
 
 	glfwSetWindowPos(s_WindowHandle, monitorWidth, monitorHeight);
 
+	int xPos = 0;
+	int yPos = 0;
+	glfwGetWindowPos(s_WindowHandle, &xPos, &yPos);
+	AtomicStore32(&s_WindowPositionX, (uint32_t)xPos);
+	AtomicStore32(&s_WindowPositionY, (uint32_t)yPos);
+
+	float xScale = 1.0f;
+	float yScale = 1.0f;
+	glfwGetWindowContentScale(s_WindowHandle, &xScale, &yScale);
+	StoreContentScale(xScale);
+
 	RegisterCallbacks(s_WindowHandle);
 
 	return 1;
@@ -112,23 +251,219 @@ const float GetTimeWindow()
 	return (float)glfwGetTime();
 }
 
-void OnUpdateWindow(float deltaTime)
+double GetTimestampWindow()
+{
+	return glfwGetTime();
+}
+
+float GetContentScaleWindow()
+{
+	uint32_t bits = AtomicLoad32(&s_ContentScaleBits);
+	float scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return scale;
+}
+
+void GetPositionWindow(int* xPos, int* yPos)
+{
+	*xPos = (int)AtomicLoad32(&s_WindowPositionX);
+	*yPos = (int)AtomicLoad32(&s_WindowPositionY);
+}
+
+void SetPositionWindow(int xPos, int yPos)
+{
+	if (s_IsThreaded)
+		PostWindowRequest(WindowRequestType_SetPosition, xPos, yPos);
+	else
+		glfwSetWindowPos(s_WindowHandle, xPos, yPos);
+}
+
+void SetSizeWindow(int width, int height)
 {
-	glfwGetFramebufferSize(s_WindowHandle, &s_WindowData.Width, &s_WindowData.Height);
-	glViewport(0, 0, s_WindowData.Width, s_WindowData.Height);
+	glfwSetWindowSize(s_WindowHandle, width, height);
+}
+
+void HideWindow()
+{
+	glfwHideWindow(s_WindowHandle);
+}
 
+void SetVSyncWindow(int enable)
+{
+	glfwSwapInterval(enable ? 1 : 0);
+}
+
+void OnUpdateWindow(float deltaTime)
+{
+	// The viewport follows the framebuffer resize events in both modes
 	glfwSwapBuffers(s_WindowHandle);
+}
 
+void PollEventsWindow()
+{
+	if (s_IsThreaded)
+		return;
+
+	s_PumpingSince = glfwGetTime();
 	glfwPollEvents();
+	s_PumpingSince = -1.0;
+}
+
+void WaitEventsWindow(double timeout)
+{
+	if (!s_IsThreaded)
+	{
+		s_PumpingSince = 0.0;
+		glfwWaitEventsTimeout(timeout);
+		s_PumpingSince = -1.0;
+		return;
+	}
+
+	// glfwWaitEvents is main thread only, the render thread sleeps until the main thread pushes an event
+	double start = glfwGetTime();
+	while (1)
+	{
+		double remaining = timeout - (glfwGetTime() - start);
+		if (remaining <= 0.0)
+			break;
+
+		// Announce the wait before the last look, a push either sees it or its event is seen here
+		AtomicStore32(&s_RenderThreadWaiting, 1);
+		AtomicFence();
+		if (!IsChannelEmpty(&s_EventChannel))
+		{
+			AtomicStore32(&s_RenderThreadWaiting, 0);
+			break;
+		}
+
+		int signaled = WaitSemaphoreTimeout(&s_EventsAvailable, (uint32_t)(remaining * 1000.0) + 1);
+		AtomicStore32(&s_RenderThreadWaiting, 0);
+
+		// A signal left over from an earlier wait wakes with nothing to read, that one waits again
+		if (!signaled || !IsChannelEmpty(&s_EventChannel))
+			break;
+	}
+}
+
+void ProcessEventsWindow()
+{
+	if (s_WindowData.EventCallback == NULL)
+		return;
+
+	if (!s_IsThreaded)
+	{
+		DrainEventQueue(s_WindowData.EventCallback);
+		return;
+	}
+
+	Event received;
+	while (TryPopChannel(&s_EventChannel, &received))
+	{
+		// The channel copy points Data into the ring slot
+		Event event;
+		CopyEvent(&event, &received);
+
+		// Only the render thread reads the sizes in this mode, so they are written here instead of in the callbacks
+		if (event.Type == EventTypeWindowResize)
+		{
+			s_WindowData.Width = event.Payload.WindowSize.Width;
+			s_WindowData.Height = event.Payload.WindowSize.Height;
+		}
+		else if (event.Type == EventTypeFramebufferResize)
+		{
+			s_WindowData.FramebufferWidth = event.Payload.WindowSize.Width;
+			s_WindowData.FramebufferHeight = event.Payload.WindowSize.Height;
+		}
+
+		s_WindowData.EventCallback(&event);
+	}
+}
+
+int BeginThreadedWindow()
+{
+	if (!InitChannel(&s_EventChannel, sizeof(Event), LSH_WINDOW_EVENT_CHANNEL_CAPACITY))
+		return 0;
+
+	if (!InitChannel(&s_RequestChannel, sizeof(WindowRequest), LSH_WINDOW_REQUEST_CHANNEL_CAPACITY))
+	{
+		ShutdownChannel(&s_EventChannel);
+		return 0;
+	}
+
+	if (!InitSemaphore(&s_EventsAvailable, 0))
+	{
+		ShutdownChannel(&s_RequestChannel);
+		ShutdownChannel(&s_EventChannel);
+		return 0;
+	}
+
+	// Events queued before the switch are dispatched while nothing else is running
+	ProcessEventsWindow();
+
+	s_IsThreaded = 1;
+	s_DroppedEventCount = 0;
+
+	glfwMakeContextCurrent(NULL);
+
+	LSH_TRACE("Window switched to render thread mode");
+
+	return 1;
+}
+
+void EndThreadedWindow()
+{
+	s_IsThreaded = 0;
+
+	glfwMakeContextCurrent(s_WindowHandle);
+
+	ShutdownChannel(&s_RequestChannel);
+	ShutdownChannel(&s_EventChannel);
+	ShutdownSemaphore(&s_EventsAvailable);
+
+	if (s_DroppedEventCount > 0)
+		LSH_WARN("%u window events were dropped in render thread mode", s_DroppedEventCount);
+}
+
+void MakeContextCurrentWindow()
+{
+	glfwMakeContextCurrent(s_WindowHandle);
+}
+
+void ReleaseContextWindow()
+{
+	glfwMakeContextCurrent(NULL);
+}
+
+void PumpEventsWindow()
+{
+	glfwWaitEvents();
+	ProcessWindowRequests();
+}
+
+void WakeWindow()
+{
+	glfwPostEmptyEvent();
 }
 
 void MinimizeWindow()
 {
+	if (s_IsThreaded)
+	{
+		PostWindowRequest(WindowRequestType_Minimize, 0, 0);
+		return;
+	}
+
 	glfwIconifyWindow(s_WindowHandle);
 }
 
 void MinMaxWindow()
 {
+	if (s_IsThreaded)
+	{
+		PostWindowRequest(WindowRequestType_MinMax, 0, 0);
+		return;
+	}
+
 	if (glfwGetWindowAttrib(s_WindowHandle, GLFW_MAXIMIZED))
 		glfwRestoreWindow(s_WindowHandle);
 	else
@@ -151,6 +486,9 @@ void WindowLogEvent(Event* event)
 	case EventTypeWindowResize:
 		LSH_TRACE("Event: Window Resize to %dx%d", ((int*)event->Data)[0], ((int*)event->Data)[1]);
 		break;
+	case EventTypeFramebufferResize:
+		LSH_TRACE("Event: Framebuffer Resize to %dx%d", ((int*)event->Data)[0], ((int*)event->Data)[1]);
+		break;
 	case EventTypeWindowMove:
 		LSH_TRACE("Event: Window Move to x:%.d, y:%d", ((int*)event->Data)[0], ((int*)event->Data)[1]);
 		break;
@@ -191,165 +529,170 @@ void SetWindowEventCallback(EventCallbackHandlefn callback)
 	s_WindowData.EventCallback = callback;
 }
 
-void WindowRefreshCallback(GLFWwindow* window)
+void SetWindowModalFrameCallback(ModalFrameCallbackfn callback)
 {
+	s_ModalFrameCallback = callback;
 }
 
-void WindowResizeCallback(GLFWwindow* window, int width, int height)
+void WindowRefreshCallback(GLFWwindow* window)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
-	data->Width = width;
-	data->Height = height;
+	// The render thread keeps presenting on its own, it only needs to know about the damage
+	if (s_IsThreaded)
+	{
+		Event event;
+		InitWindowEvent(&event, EventTypeWindowRefresh, 0);
+		SubmitEvent(&event);
+		return;
+	}
 
-	Event event;
-	event.Type = EventTypeWindowResize;
-	event.Data = (void*)malloc(sizeof(ivec2));
-	glm_ivec2_copy((ivec2){ width, height }, *(ivec2*)event.Data);
-	event.Size = sizeof(ivec2);
-	event.Handled = 0;
+	// Contents were damaged by the system, the skipped frame logic can't see that
+	RequestRedrawRenderer();
+
+	// Normally the frame loop renders once polling returns, events are left for its ProcessEventsWindow
+	if (s_PumpingSince < 0.0 || s_ModalFrameCallback == NULL)
+		return;
 
-	data->EventCallback(&event);
+	double now = glfwGetTime();
+	if (s_PumpingSince == 0.0)
+		s_PumpingSince = now;
+	if (now - s_PumpingSince < LSH_WINDOW_MODAL_LOOP_THRESHOLD)
+		return;
 
-	float deltaTime = GetTimeWindow();
-	deltaTime -= s_LastFrameTime;
-	s_LastFrameTime = GetTimeWindow();
+	// The main loop is blocked in a modal resize or move, the frame is run from here
+	s_ModalFrameCallback();
+}
+
+void WindowResizeCallback(GLFWwindow* window, int width, int height)
+{
+	if (!s_IsThreaded)
+	{
+		WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
+		data->Width = width;
+		data->Height = height;
+	}
 
-	deltaTime *= 1000.f;
+	// Rendering during a resize happens once per refresh, not per size step
+	Event event;
+	InitWindowEvent(&event, EventTypeWindowResize, sizeof(WindowSizePayload));
+	event.Payload.WindowSize.Width = width;
+	event.Payload.WindowSize.Height = height;
 
-	glfwGetFramebufferSize(s_WindowHandle, &s_WindowData.Width, &s_WindowData.Height);
-	glViewport(0, 0, s_WindowData.Width, s_WindowData.Height);
+	SubmitEvent(&event);
+}
 
-	glfwSwapBuffers(s_WindowHandle);
+// Screen coordinates and pixels only match at a content scale of 1, the renderer sizes its viewport from this one
+void FramebufferResizeCallback(GLFWwindow* window, int width, int height)
+{
+	if (!s_IsThreaded)
+	{
+		WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
+		data->FramebufferWidth = width;
+		data->FramebufferHeight = height;
+	}
 
-	BeginRendering();
-	OnUpdateRenderer(deltaTime);
-	EndRendering();
+	Event event;
+	InitWindowEvent(&event, EventTypeFramebufferResize, sizeof(WindowSizePayload));
+	event.Payload.WindowSize.Width = width;
+	event.Payload.WindowSize.Height = height;
 
-	//LSH_TRACE("Frame Time: %.3f ms (%.1f FPS)", deltaTime, 1000.0f / deltaTime);
+	SubmitEvent(&event);
 }
 
 void WindowCloseCallback(GLFWwindow* window)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
-
 	Event event;
-	event.Type = EventTypeWindowClose;
-	event.Data = NULL;
-	event.Size = 0;
-	event.Handled = 0;
+	InitWindowEvent(&event, EventTypeWindowClose, 0);
 
-	data->EventCallback(&event);
+	SubmitEvent(&event);
 }
 
 void WindowPositionCallback(GLFWwindow* window, int xPos, int yPos)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
+	AtomicStore32(&s_WindowPositionX, (uint32_t)xPos);
+	AtomicStore32(&s_WindowPositionY, (uint32_t)yPos);
 
 	Event event;
-	event.Type = EventTypeWindowMove;
-	event.Data = (void*)malloc(sizeof(ivec2));
-	glm_ivec2_copy((ivec2) { xPos, yPos }, * (ivec2*)event.Data);
-	event.Size = sizeof(ivec2);
-	event.Handled = 0;
+	InitWindowEvent(&event, EventTypeWindowMove, sizeof(WindowPositionPayload));
+	event.Payload.WindowPosition.X = xPos;
+	event.Payload.WindowPosition.Y = yPos;
 
-	data->EventCallback(&event);
+	SubmitEvent(&event);
 }
 
 void WindowKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
-
-	Event event;
+	EventType type = EventTypeKeyPressed;
 
 	switch (action)
 	{
 	case GLFW_PRESS:
-		event.Type = EventTypeKeyPressed;
+		type = EventTypeKeyPressed;
 		break;
 	case GLFW_RELEASE:
-		event.Type = EventTypeKeyReleased;
+		type = EventTypeKeyReleased;
 		break;
 	case GLFW_REPEAT:
-		event.Type = EventTypeKeyRepeat;
+		type = EventTypeKeyRepeat;
 	}
 
-	event.Data = (void*)malloc(3 * sizeof(int));
-	((int*)event.Data)[0] = key;
-	((int*)event.Data)[1] = scancode;
-	((int*)event.Data)[2] = action;
-	event.Size = 3 * sizeof(int);
-	event.Handled = 0;
+	Event event;
+	InitWindowEvent(&event, type, sizeof(KeyPayload));
+	event.Payload.Key.Key = key;
+	event.Payload.Key.Scancode = scancode;
+	event.Payload.Key.Action = action;
 
-	data->EventCallback(&event);
+	SubmitEvent(&event);
 }
 
 void WindowCharacterCallback(GLFWwindow* window, unsigned int keycode)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
-
 	Event event;
-	event.Type = EventTypeKeyTyped;
-	event.Data = (void*)malloc(sizeof(unsigned int));
-	((unsigned int*)event.Data)[0] = keycode;
-	event.Size = sizeof(unsigned int);
-	event.Handled = 0;
+	InitWindowEvent(&event, EventTypeKeyTyped, sizeof(KeyTypedPayload));
+	event.Payload.KeyTyped.Codepoint = keycode;
 
-	data->EventCallback(&event);
+	SubmitEvent(&event);
 }
 
 void WindowMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
-
-	Event event;
+	EventType type = EventTypeMouseButtonPressed;
 
 	switch (action)
 	{
 	case GLFW_PRESS:
-		event.Type = EventTypeMouseButtonPressed;
+		type = EventTypeMouseButtonPressed;
 		break;
 	case GLFW_RELEASE:
-		event.Type = EventTypeMouseButtonReleased;
+		type = EventTypeMouseButtonReleased;
 		break;
 	case GLFW_REPEAT:
-		event.Type = EventTypeMouseButtonRepeat;
+		type = EventTypeMouseButtonRepeat;
 	}
 
-	event.Data = (void*)malloc(2 * sizeof(int));
-	((int*)event.Data)[0] = button;
-	((int*)event.Data)[1] = action;
-	event.Size = 2 * sizeof(int);
-	event.Handled = 0;
+	Event event;
+	InitWindowEvent(&event, type, sizeof(MouseButtonPayload));
+	event.Payload.MouseButton.Button = button;
+	event.Payload.MouseButton.Action = action;
 
-	data->EventCallback(&event);
+	SubmitEvent(&event);
 }
 
 void WindowCursorPositionCallback(GLFWwindow* window, double xPos, double yPos)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
-
 	Event event;
-	event.Type = EventTypeMouseMoved;
-	event.Data = (void*)malloc(2 * sizeof(double));
-	((double*)event.Data)[0] = xPos;
-	((double*)event.Data)[1] = yPos;
-	event.Size = 2 * sizeof(double);
-	event.Handled = 0;
+	InitWindowEvent(&event, EventTypeMouseMoved, sizeof(MousePositionPayload));
+	event.Payload.MousePosition.X = xPos;
+	event.Payload.MousePosition.Y = yPos;
 
-	data->EventCallback(&event);
+	SubmitEvent(&event);
 }
 
 void WindowScrollCallback(GLFWwindow* window, double xOffset, double yOffset)
 {
-	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
-
 	Event event;
-	event.Type = EventTypeMouseScrolled;
-	event.Data = (void*)malloc(2 * sizeof(double));
-	((double*)event.Data)[0] = xOffset;
-	((double*)event.Data)[1] = yOffset;
-	event.Size = 2 * sizeof(double);
-	event.Handled = 0;
-
-	data->EventCallback(&event);
+	InitWindowEvent(&event, EventTypeMouseScrolled, sizeof(MouseScrollPayload));
+	event.Payload.MouseScroll.XOffset = xOffset;
+	event.Payload.MouseScroll.YOffset = yOffset;
+
+	SubmitEvent(&event);
 }
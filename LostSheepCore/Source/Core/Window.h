@@ -7,11 +7,15 @@ typedef struct Event Event;
 
 typedef void (* EventCallbackHandlefn)(Event* Event);
 
+typedef void (* ModalFrameCallbackfn)();
+
 typedef struct WindowData
 {
 	const char* Title;
-	int Width;
+	int Width; // Screen coordinates, the UI is laid out and the cursor is reported in these
 	int Height;
+	int FramebufferWidth; // Pixels, differs from the size when the content scale isn't 1
+	int FramebufferHeight;
 	EventCallbackHandlefn EventCallback;
 } WindowData;
 
@@ -28,8 +32,53 @@ const WindowData* GetWindowData();
 
 const float GetTimeWindow();
 
+// Same clock as Event timestamps, in seconds
+double GetTimestampWindow();
+
+// Ratio between framebuffer pixels and screen coordinates
+float GetContentScaleWindow();
+
+// Safe from the render thread, the position is cached from the position callback
+void GetPositionWindow(int* xPos, int* yPos);
+
+void SetPositionWindow(int xPos, int yPos);
+
+// Main thread only, used by event replay
+void SetSizeWindow(int width, int height);
+
+void HideWindow();
+
+void SetVSyncWindow(int enable);
+
+// Presents the frame
 void OnUpdateWindow(float deltaTime);
 
+// Queues the events that arrived since the last poll, the render thread receives them from the main thread instead
+void PollEventsWindow();
+
+// Sleeps until an event arrives or the timeout in seconds expires
+void WaitEventsWindow(double timeout);
+
+// Dispatches the events queued by the GLFW callbacks since the last call
+void ProcessEventsWindow();
+
+// Render thread mode: the main thread only polls and applies window requests, events reach
+// the render thread through a lock-free channel. Called on the main thread, releases the context
+int BeginThreadedWindow();
+
+// Called on the main thread after the render thread has finished, takes the context back
+void EndThreadedWindow();
+
+void MakeContextCurrentWindow();
+
+void ReleaseContextWindow();
+
+// Main thread loop body in render thread mode, blocks until an event or a wake up
+void PumpEventsWindow();
+
+// Wakes up PumpEventsWindow, safe from any thread
+void WakeWindow();
+
 void MinimizeWindow();
 
 void MinMaxWindow();
@@ -41,10 +90,15 @@ void WindowLogEvent(Event* event);
 // Events
 void SetWindowEventCallback(EventCallbackHandlefn callback);
 
+// Runs a whole frame from the refresh callback while a modal resize or move keeps polling from returning
+void SetWindowModalFrameCallback(ModalFrameCallbackfn callback);
+
 void WindowRefreshCallback(GLFWwindow* window);
 
 void WindowResizeCallback(GLFWwindow* window, int width, int height);
 
+void FramebufferResizeCallback(GLFWwindow* window, int width, int height);
+
 void WindowCloseCallback(GLFWwindow* window);
 
 void WindowPositionCallback(GLFWwindow* window, int xPos, int yPos);
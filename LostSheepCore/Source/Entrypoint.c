@@ -1,7 +1,33 @@
 #include "Core/Application.h"
+#include "Core/Log.h"
 
-int main()
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char** argv)
 {
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--render-thread") == 0)
+            EnableRenderThreadApplication(1);
+        else if (strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc)
+            SetFramePacingApplication(FramePacingMode_Capped, (float)atof(argv[++i]));
+        else if (strcmp(argv[i], "--unlimited") == 0)
+            SetFramePacingApplication(FramePacingMode_Unlimited, 0.0f);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            RecordEventsApplication(argv[++i]);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            ReplayEventsApplication(argv[++i], 0);
+        else if (strcmp(argv[i], "--replay-fixed") == 0 && i + 1 < argc)
+            ReplayEventsApplication(argv[++i], 1);
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            ProfileApplication(argv[++i]);
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+            SetLogLevelFromString(argv[++i]);
+        else if (strcmp(argv[i], "--log-deferred") == 0)
+            SetLogDeferredFormatting(1);
+    }
+
     if (!InitApplication("Lost Sheep", 1280, 720))
     {
         return -1;
@@ -10,4 +36,4 @@ int main()
     RunApplication();
 
     ShutdownApplication();
-}
\ No newline at end of file
+}
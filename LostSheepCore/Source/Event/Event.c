@@ -1,5 +1,36 @@
+#define LSH_LOG_CATEGORY LogCategory_Event
+
 #include "Event.h"
 
+#include "Core/Log.h"
+
+#include <stddef.h>
+
+typedef struct EventSubscription
+{
+	EventCallbackfn Callback;
+	int Priority;
+} EventSubscription;
+
+// Each row is kept sorted by priority
+static EventSubscription s_Subscriptions[EventTypeCount][LSH_EVENT_MAX_SUBSCRIBERS];
+static uint32_t s_SubscriptionCounts[EventTypeCount];
+
+void InitEvent(Event* event, EventType type, uint32_t size)
+{
+	event->Type = type;
+	event->Data = size > 0 ? (void*)&event->Payload : NULL;
+	event->Size = size;
+	event->Handled = 0;
+	event->Timestamp = 0.0;
+}
+
+void CopyEvent(Event* destination, const Event* source)
+{
+	*destination = *source;
+	destination->Data = source->Data != NULL ? (void*)&destination->Payload : NULL;
+}
+
 int DispatchEvent(EventType type, Event* event, EventCallbackfn callback)
 {
 	if (!event->Handled)
@@ -16,3 +47,64 @@ int DispatchEvent(EventType type, Event* event, EventCallbackfn callback)
 
 	return 0;
 }
+
+int SubscribeEvent(EventType type, EventCallbackfn callback, int priority)
+{
+	if (type <= None || type >= EventTypeCount || callback == NULL)
+		return 0;
+
+	EventSubscription* subscriptions = s_Subscriptions[type];
+	uint32_t count = s_SubscriptionCounts[type];
+	if (count >= LSH_EVENT_MAX_SUBSCRIBERS)
+	{
+		LSH_ERROR("Too many subscribers for event type %d", (int)type);
+		return 0;
+	}
+
+	// Insert after every subscriber of the same or a lower priority
+	uint32_t index = count;
+	while (index > 0 && subscriptions[index - 1].Priority > priority)
+	{
+		subscriptions[index] = subscriptions[index - 1];
+		index--;
+	}
+
+	subscriptions[index].Callback = callback;
+	subscriptions[index].Priority = priority;
+	s_SubscriptionCounts[type]++;
+
+	return 1;
+}
+
+void UnsubscribeEvent(EventType type, EventCallbackfn callback)
+{
+	if (type <= None || type >= EventTypeCount)
+		return;
+
+	EventSubscription* subscriptions = s_Subscriptions[type];
+	uint32_t count = s_SubscriptionCounts[type];
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (subscriptions[i].Callback != callback)
+			continue;
+
+		for (uint32_t j = i + 1; j < count; j++)
+			subscriptions[j - 1] = subscriptions[j];
+		s_SubscriptionCounts[type]--;
+		return;
+	}
+}
+
+void PublishEvent(Event* event)
+{
+	if (event->Type <= None || event->Type >= EventTypeCount)
+		return;
+
+	const EventSubscription* subscriptions = s_Subscriptions[event->Type];
+	uint32_t count = s_SubscriptionCounts[event->Type];
+	for (uint32_t i = 0; i < count && !event->Handled; i++)
+	{
+		if (subscriptions[i].Callback(event))
+			event->Handled = 1;
+	}
+}
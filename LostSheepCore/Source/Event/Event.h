@@ -7,22 +7,107 @@
 typedef enum EventType
 {
 	None = 0,
-	EventTypeWindowClose, EventTypeWindowResize, EventTypeWindowMove,
+	EventTypeWindowClose, EventTypeWindowResize, EventTypeWindowMove, EventTypeWindowRefresh,
 	EventTypeKeyPressed, EventTypeKeyReleased, EventTypeKeyRepeat, EventTypeKeyTyped,
-	EventTypeMouseButtonPressed, EventTypeMouseButtonReleased, EventTypeMouseButtonRepeat, EventTypeMouseMoved, EventTypeMouseScrolled
+	EventTypeMouseButtonPressed, EventTypeMouseButtonReleased, EventTypeMouseButtonRepeat, EventTypeMouseMoved, EventTypeMouseScrolled,
+	EventTypeFramebufferResize, // Appended so the values in existing recordings stay valid
+
+	EventTypeCount
 } EventType;
 
+#define LSH_EVENT_MAX_SUBSCRIBERS 16
+
+// Lower runs first, subsystems closer to the platform get the first look at an event
+typedef enum EventPriority
+{
+	EventPriorityInput = -100, // Only observes, never handles
+	EventPriorityApplication = 0,
+	EventPriorityRenderer = 100,
+	EventPriorityUI = 200
+} EventPriority;
+
+// Payload layouts match what handlers read through Data, e.g. ((int*)event->Data)[0]
+typedef struct WindowSizePayload
+{
+	int Width;
+	int Height;
+} WindowSizePayload;
+
+typedef struct WindowPositionPayload
+{
+	int X;
+	int Y;
+} WindowPositionPayload;
+
+typedef struct KeyPayload
+{
+	int Key;
+	int Scancode;
+	int Action;
+} KeyPayload;
+
+typedef struct KeyTypedPayload
+{
+	unsigned int Codepoint;
+} KeyTypedPayload;
+
+typedef struct MouseButtonPayload
+{
+	int Button;
+	int Action;
+} MouseButtonPayload;
+
+typedef struct MousePositionPayload
+{
+	double X;
+	double Y;
+} MousePositionPayload;
+
+typedef struct MouseScrollPayload
+{
+	double XOffset;
+	double YOffset;
+} MouseScrollPayload;
+
+typedef union EventPayload
+{
+	WindowSizePayload WindowSize;
+	WindowPositionPayload WindowPosition;
+	KeyPayload Key;
+	KeyTypedPayload KeyTyped;
+	MouseButtonPayload MouseButton;
+	MousePositionPayload MousePosition;
+	MouseScrollPayload MouseScroll;
+} EventPayload;
+
 typedef struct Event
 {
 	EventType Type;
-	void* Data;
+	void* Data; // Points at Payload, NULL for events without data
 	uint32_t Size;
 
 	int Handled;
+
+	double Timestamp; // Seconds on the window clock, taken when the platform reported the event, the first one for coalesced events
+
+	EventPayload Payload;
 } Event;
 
 typedef void (*EventCallbackHandlefn)(Event* event);
 
 typedef int (*EventCallbackfn)(Event* event);
 
-int DispatchEvent(EventType type, Event* event, EventCallbackfn callback);
\ No newline at end of file
+// Data is pointed at the inline payload, re-initialize copies so they don't point into the original
+void InitEvent(Event* event, EventType type, uint32_t size);
+
+void CopyEvent(Event* destination, const Event* source);
+
+int DispatchEvent(EventType type, Event* event, EventCallbackfn callback);
+
+// Handlers of the same priority run in subscription order, returns 0 if the type's table is full
+int SubscribeEvent(EventType type, EventCallbackfn callback, int priority);
+
+void UnsubscribeEvent(EventType type, EventCallbackfn callback);
+
+// Walks the handlers subscribed to the event's type until one of them handles it
+void PublishEvent(Event* event);
\ No newline at end of file
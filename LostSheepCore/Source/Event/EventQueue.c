@@ -0,0 +1,92 @@
+#define LSH_LOG_CATEGORY LogCategory_Event
+
+#include "EventQueue.h"
+
+#include "Core/Log.h"
+
+#include <string.h>
+
+static Event s_Events[LSH_EVENT_QUEUE_CAPACITY];
+static uint32_t s_Head = 0;
+static uint32_t s_Count = 0;
+
+static EventQueueStats s_Stats;
+static EventQueueStats s_LastDrainStats;
+
+// Merges into the newest queued event if both are of the same coalescable type,
+// the merged event keeps the timestamp of the first one so input latency is measured from the oldest input
+static int CoalesceEvent(const Event* event)
+{
+	if (s_Count == 0)
+		return 0;
+
+	Event* last = &s_Events[(s_Head + s_Count - 1) % LSH_EVENT_QUEUE_CAPACITY];
+	if (last->Type != event->Type)
+		return 0;
+
+	switch (event->Type)
+	{
+	case EventTypeMouseMoved:
+		last->Payload.MousePosition = event->Payload.MousePosition;
+		s_Stats.CoalescedMouseMoves++;
+		return 1;
+	case EventTypeWindowResize:
+	case EventTypeFramebufferResize:
+		last->Payload.WindowSize = event->Payload.WindowSize;
+		s_Stats.CoalescedResizes++;
+		return 1;
+	case EventTypeMouseScrolled:
+		// Offsets are relative, they add up
+		last->Payload.MouseScroll.XOffset += event->Payload.MouseScroll.XOffset;
+		last->Payload.MouseScroll.YOffset += event->Payload.MouseScroll.YOffset;
+		s_Stats.CoalescedScrolls++;
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+void PushEvent(const Event* event)
+{
+	s_Stats.Queued++;
+
+	if (CoalesceEvent(event))
+		return;
+
+	if (s_Count >= LSH_EVENT_QUEUE_CAPACITY)
+	{
+		if (s_Stats.Dropped == 0)
+			LSH_WARN("Event queue is full, dropping events");
+		s_Stats.Dropped++;
+		return;
+	}
+
+	CopyEvent(&s_Events[(s_Head + s_Count) % LSH_EVENT_QUEUE_CAPACITY], event);
+	s_Count++;
+}
+
+void DrainEventQueue(EventCallbackHandlefn callback)
+{
+	uint32_t count = s_Count;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		// Copied out, events pushed from the callback can reuse the slot
+		Event event;
+		CopyEvent(&event, &s_Events[s_Head]);
+
+		s_Head = (s_Head + 1) % LSH_EVENT_QUEUE_CAPACITY;
+		s_Count--;
+
+		callback(&event);
+		s_Stats.Dispatched++;
+	}
+
+	s_LastDrainStats = s_Stats;
+	memset(&s_Stats, 0, sizeof(EventQueueStats));
+}
+
+const EventQueueStats* GetEventQueueStats()
+{
+	return &s_LastDrainStats;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Event/Event.h"
+
+#include <stdint.h>
+
+#define LSH_EVENT_QUEUE_CAPACITY 256
+
+typedef struct EventQueueStats
+{
+	uint32_t Queued; // Events that reached the queue, including merged ones
+	uint32_t Dispatched;
+	uint32_t CoalescedMouseMoves;
+	uint32_t CoalescedScrolls;
+	uint32_t CoalescedResizes;
+	uint32_t Dropped; // Queue was full
+} EventQueueStats;
+
+// Consecutive mouse-move, scroll and resize events are merged into the queued one
+void PushEvent(const Event* event);
+
+// Dispatches the events queued so far, events pushed while draining wait for the next drain
+void DrainEventQueue(EventCallbackHandlefn callback);
+
+// Counters of the last drain
+const EventQueueStats* GetEventQueueStats();
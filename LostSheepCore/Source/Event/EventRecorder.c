@@ -0,0 +1,229 @@
+#define LSH_LOG_CATEGORY LogCategory_Event
+
+#include "EventRecorder.h"
+
+#include "Core/Log.h"
+#include "Core/Memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ReplayRecord
+{
+	uint32_t Frame;
+	Event Event;
+} ReplayRecord;
+
+static FILE* s_RecordingFile = NULL;
+static uint32_t s_RecordingFrame = 0;
+static uint32_t s_RecordedEventCount = 0;
+static double s_RecordingStartTime = 0.0;
+
+static ReplayRecord* s_ReplayRecords = NULL;
+static uint32_t s_ReplayRecordCount = 0;
+static uint32_t s_ReplayCursor = 0;
+static uint32_t s_ReplayFrame = 0;
+static EventRecordingHeader s_ReplayHeader;
+
+int BeginEventRecording(const char* path, int width, int height, double startTime)
+{
+	s_RecordingFile = fopen(path, "wb");
+	if (s_RecordingFile == NULL)
+	{
+		LSH_ERROR("Failed to open event recording %s", path);
+		return 0;
+	}
+
+	EventRecordingHeader header = { LSH_EVENT_RECORDING_MAGIC, LSH_EVENT_RECORDING_VERSION, width, height };
+	fwrite(&header, sizeof(EventRecordingHeader), 1, s_RecordingFile);
+
+	s_RecordingFrame = 0;
+	s_RecordedEventCount = 0;
+	s_RecordingStartTime = startTime;
+
+	LSH_INFO("Recording events to %s (%dx%d)", path, width, height);
+
+	return 1;
+}
+
+int IsRecordingEvents()
+{
+	return s_RecordingFile != NULL;
+}
+
+void RecordEvent(const Event* event)
+{
+	if (s_RecordingFile == NULL)
+		return;
+
+	double timestamp = event->Timestamp - s_RecordingStartTime;
+	uint16_t type = (uint16_t)event->Type;
+	uint16_t size = (uint16_t)event->Size;
+
+	fwrite(&s_RecordingFrame, sizeof(uint32_t), 1, s_RecordingFile);
+	fwrite(&timestamp, sizeof(double), 1, s_RecordingFile);
+	fwrite(&type, sizeof(uint16_t), 1, s_RecordingFile);
+	fwrite(&size, sizeof(uint16_t), 1, s_RecordingFile);
+	if (size > 0)
+		fwrite(event->Data, size, 1, s_RecordingFile);
+
+	s_RecordedEventCount++;
+}
+
+void EndEventRecordingFrame()
+{
+	s_RecordingFrame++;
+}
+
+void EndEventRecording()
+{
+	if (s_RecordingFile == NULL)
+		return;
+
+	fclose(s_RecordingFile);
+	s_RecordingFile = NULL;
+
+	LSH_INFO("Recorded %u events over %u frames", s_RecordedEventCount, s_RecordingFrame);
+}
+
+static int ReadRecord(FILE* file, ReplayRecord* record)
+{
+	double timestamp = 0.0;
+	uint16_t type = 0;
+	uint16_t size = 0;
+
+	if (fread(&record->Frame, sizeof(uint32_t), 1, file) != 1)
+		return 0;
+
+	if (fread(&timestamp, sizeof(double), 1, file) != 1 ||
+		fread(&type, sizeof(uint16_t), 1, file) != 1 ||
+		fread(&size, sizeof(uint16_t), 1, file) != 1)
+	{
+		LSH_WARN("Event recording is truncated");
+		return 0;
+	}
+
+	if (type == None || type >= EventTypeCount || size > sizeof(EventPayload))
+	{
+		LSH_ERROR("Event recording is corrupted (type %u, size %u)", type, size);
+		return 0;
+	}
+
+	InitEvent(&record->Event, (EventType)type, size);
+	record->Event.Timestamp = timestamp;
+
+	if (size > 0 && fread(record->Event.Data, size, 1, file) != 1)
+	{
+		LSH_WARN("Event recording is truncated");
+		return 0;
+	}
+
+	return 1;
+}
+
+int LoadEventReplay(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		LSH_ERROR("Failed to open event recording %s", path);
+		return 0;
+	}
+
+	if (fread(&s_ReplayHeader, sizeof(EventRecordingHeader), 1, file) != 1 ||
+		s_ReplayHeader.Magic != LSH_EVENT_RECORDING_MAGIC ||
+		s_ReplayHeader.Version != LSH_EVENT_RECORDING_VERSION)
+	{
+		LSH_ERROR("%s is not an event recording of version %d", path, LSH_EVENT_RECORDING_VERSION);
+		fclose(file);
+		return 0;
+	}
+
+	uint32_t capacity = 1024;
+	s_ReplayRecords = (ReplayRecord*)LSH_MALLOC(capacity * sizeof(ReplayRecord), MemoryTag_Event);
+	s_ReplayRecordCount = 0;
+
+	ReplayRecord record;
+	while (s_ReplayRecords != NULL && ReadRecord(file, &record))
+	{
+		if (s_ReplayRecordCount == capacity)
+		{
+			capacity *= 2;
+			ReplayRecord* records = (ReplayRecord*)LSH_REALLOC(s_ReplayRecords, capacity * sizeof(ReplayRecord), MemoryTag_Event);
+			if (records == NULL)
+				break;
+			s_ReplayRecords = records;
+		}
+
+		// Data is re-pointed at dispatch, the array may still move
+		s_ReplayRecords[s_ReplayRecordCount++] = record;
+	}
+
+	fclose(file);
+
+	if (s_ReplayRecords == NULL)
+	{
+		LSH_FATAL("Failed to allocate memory for event replay");
+		return 0;
+	}
+
+	s_ReplayCursor = 0;
+	s_ReplayFrame = 0;
+
+	LSH_INFO("Replaying %u events from %s (%dx%d)", s_ReplayRecordCount, path, s_ReplayHeader.Width, s_ReplayHeader.Height);
+
+	return 1;
+}
+
+int IsReplayingEvents()
+{
+	return s_ReplayRecords != NULL;
+}
+
+void GetEventReplayWindowSize(int* width, int* height)
+{
+	*width = s_ReplayHeader.Width;
+	*height = s_ReplayHeader.Height;
+}
+
+int ReplayEventsFrame(int fixedRate, double elapsed, EventCallbackHandlefn callback)
+{
+	if (s_ReplayCursor >= s_ReplayRecordCount)
+		return -1;
+
+	int dispatched = 0;
+	while (s_ReplayCursor < s_ReplayRecordCount)
+	{
+		ReplayRecord* record = &s_ReplayRecords[s_ReplayCursor];
+		if (fixedRate ? record->Frame > s_ReplayFrame : record->Event.Timestamp > elapsed)
+			break;
+
+		Event event;
+		CopyEvent(&event, &record->Event);
+		callback(&event);
+
+		s_ReplayCursor++;
+		dispatched++;
+	}
+
+	s_ReplayFrame++;
+
+	return dispatched;
+}
+
+double GetNextEventReplayTime()
+{
+	if (s_ReplayCursor >= s_ReplayRecordCount)
+		return -1.0;
+
+	return s_ReplayRecords[s_ReplayCursor].Event.Timestamp;
+}
+
+void UnloadEventReplay()
+{
+	LSH_FREE(s_ReplayRecords);
+	s_ReplayRecords = NULL;
+	s_ReplayRecordCount = 0;
+	s_ReplayCursor = 0;
+}
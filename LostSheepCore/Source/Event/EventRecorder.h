@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Event/Event.h"
+
+#include <stdint.h>
+
+// Recording layout: EventRecordingHeader followed by one record per dispatched event,
+// each record is frame index, timestamp since the start, type and size, then the payload bytes
+#define LSH_EVENT_RECORDING_MAGIC 0x4845534Cu // "LSEH"
+#define LSH_EVENT_RECORDING_VERSION 1
+
+typedef struct EventRecordingHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	int32_t Width; // Window size when the recording started
+	int32_t Height;
+} EventRecordingHeader;
+
+// Recording, events are written in the order they are dispatched
+int BeginEventRecording(const char* path, int width, int height, double startTime);
+
+int IsRecordingEvents();
+
+void RecordEvent(const Event* event);
+
+// Events recorded after this belong to the next frame
+void EndEventRecordingFrame();
+
+void EndEventRecording();
+
+// Replay, the whole recording is loaded up front so reading it never shows up in frame times
+int LoadEventReplay(const char* path);
+
+int IsReplayingEvents();
+
+void GetEventReplayWindowSize(int* width, int* height);
+
+// Fixed rate: dispatches the events of the next recorded frame.
+// Real time: dispatches the events recorded up to elapsed seconds since the replay started.
+// Returns the number of dispatched events or -1 once the recording is exhausted
+int ReplayEventsFrame(int fixedRate, double elapsed, EventCallbackHandlefn callback);
+
+// Seconds from the start of the recording to the next pending event, -1 if none are left
+double GetNextEventReplayTime();
+
+void UnloadEventReplay();
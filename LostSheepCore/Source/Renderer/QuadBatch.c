@@ -0,0 +1,203 @@
+#define LSH_LOG_CATEGORY LogCategory_Renderer
+
+#include "QuadBatch.h"
+
+#include "Core/Log.h"
+
+#include "Renderer/RenderState.h"
+#include "Renderer/RendererStats.h"
+#include "Renderer/Shader.h"
+#include "Renderer/StreamBuffer.h"
+#include "Renderer/Text.h"
+
+#include "glad/glad.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static uint32_t s_QuadVAO;
+
+static QuadInstance s_Instances[LSH_QUAD_BATCH_MAX_INSTANCES];
+static uint32_t s_InstanceCount = 0;
+
+static uint32_t s_TextureSlots[LSH_QUAD_BATCH_MAX_TEXTURES];
+static uint32_t s_TextureSlotCount = 0;
+
+// Union of the ShaderFeature bits needed by the queued quads
+static uint32_t s_BatchFeatures = ShaderFeature_None;
+
+// Instances live in the stream buffer, attributes are only re-pointed per flush without base instance support
+static void SetInstanceAttributes(uint32_t baseOffset)
+{
+	BindBuffer(GL_ARRAY_BUFFER, GetStreamBufferRendererID());
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(baseOffset + offsetof(QuadInstance, Position)));
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(baseOffset + offsetof(QuadInstance, Size)));
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(baseOffset + offsetof(QuadInstance, Color)));
+	glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(baseOffset + offsetof(QuadInstance, CornerRadius)));
+	glVertexAttribIPointer(6, 1, GL_INT, sizeof(QuadInstance), (void*)(baseOffset + offsetof(QuadInstance, TextureSlot)));
+}
+
+// Quads that blend would hide text queued before them, they write depth but the text is drawn later.
+// Queued quads all come before that text in command order, so they are drawn first, then the text
+static void FlushQueuedText()
+{
+	if (GetQueuedGlyphCount() == 0)
+		return;
+
+	FlushQuadBatch();
+	FlushTextBatch();
+}
+
+// Opaque square quads hide the text behind them through the depth test alone
+static int IsOpaqueQuad(const QuadInstance* instance)
+{
+	return instance->Color.a >= 1.0f && instance->TextureSlot < 0 && instance->CornerRadius <= 0.0f && instance->BorderThickness <= 0.0f;
+}
+
+void InitQuadBatch(uint32_t quadVBO, uint32_t quadIBO)
+{
+	glGenVertexArrays(1, &s_QuadVAO);
+	BindVertexArray(s_QuadVAO);
+
+	BindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIBO);
+
+	// Per-vertex unit quad
+	BindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+
+	// Per-instance data
+	SetInstanceAttributes(0);
+
+	for (uint32_t i = 2; i <= 6; i++)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+
+	BindVertexArray(0);
+
+	// Sampler array is bound to fixed texture units once
+	int samplers[LSH_QUAD_BATCH_MAX_TEXTURES];
+	for (int i = 0; i < LSH_QUAD_BATCH_MAX_TEXTURES; i++)
+		samplers[i] = i;
+
+	for (uint32_t features = 0; features < LSH_SHADER_VARIANT_COUNT; features++)
+	{
+		SetActiveShaderVariant(UIShaderType_Image, features);
+		UploadUniform1iv(ShaderUniform_Textures, samplers, LSH_QUAD_BATCH_MAX_TEXTURES);
+	}
+
+	LSH_TRACE("Quad batch initialized");
+}
+
+void BeginQuadBatch()
+{
+	s_InstanceCount = 0;
+	s_TextureSlotCount = 0;
+	s_BatchFeatures = ShaderFeature_None;
+}
+
+int AcquireQuadBatchTextureSlot(uint32_t textureRendererID)
+{
+	// A flush in the following SubmitQuad would drop the slot, room for the quad is made first.
+	// Images may blend, so text queued before them is drawn here as well
+	FlushQueuedText();
+	if (s_InstanceCount >= LSH_QUAD_BATCH_MAX_INSTANCES)
+		FlushQuadBatch();
+
+	for (uint32_t i = 0; i < s_TextureSlotCount; i++)
+	{
+		if (s_TextureSlots[i] == textureRendererID)
+			return (int)i;
+	}
+
+	if (s_TextureSlotCount >= LSH_QUAD_BATCH_MAX_TEXTURES)
+		FlushQuadBatch();
+
+	s_TextureSlots[s_TextureSlotCount] = textureRendererID;
+	return (int)(s_TextureSlotCount++);
+}
+
+void SubmitQuad(const QuadInstance* instance)
+{
+	if (!IsOpaqueQuad(instance))
+		FlushQueuedText();
+
+	if (s_InstanceCount >= LSH_QUAD_BATCH_MAX_INSTANCES)
+		FlushQuadBatch();
+
+	s_Instances[s_InstanceCount++] = *instance;
+
+	if (instance->CornerRadius > 0.0f)
+		s_BatchFeatures |= ShaderFeature_Rounded;
+	if (instance->BorderThickness > 0.0f)
+		s_BatchFeatures |= ShaderFeature_Border;
+}
+
+void FlushQuadBatch()
+{
+	if (s_InstanceCount == 0)
+	{
+		s_TextureSlotCount = 0;
+		s_BatchFeatures = ShaderFeature_None;
+		return;
+	}
+
+	// Image shader is a superset of the rectangle shader, only needed when a texture is sampled,
+	// the variant is the cheapest one covering every quad in the batch
+	if (s_TextureSlotCount > 0)
+	{
+		SetActiveShaderVariant(UIShaderType_Image, s_BatchFeatures);
+		for (uint32_t i = 0; i < s_TextureSlotCount; i++)
+			BindTexture2D(i, s_TextureSlots[i]);
+	}
+	else
+	{
+		SetActiveShaderVariant(UIShaderType_Rectangle, s_BatchFeatures);
+	}
+
+	uint32_t size = s_InstanceCount * (uint32_t)sizeof(QuadInstance);
+	StreamAllocation allocation = AllocateStreamBuffer(size, (uint32_t)sizeof(QuadInstance));
+	if (allocation.Data == NULL)
+	{
+		LSH_ERROR("Failed to allocate %u quad instances from the stream buffer", s_InstanceCount);
+		s_InstanceCount = 0;
+		s_TextureSlotCount = 0;
+		s_BatchFeatures = ShaderFeature_None;
+		return;
+	}
+
+	memcpy(allocation.Data, s_Instances, size);
+	CommitStreamBuffer(&allocation);
+	CountQuads(s_InstanceCount);
+
+	BindVertexArray(s_QuadVAO);
+	if (IsBaseInstanceSupported())
+	{
+		DrawQuadsInstanced(s_InstanceCount, allocation.Offset / (uint32_t)sizeof(QuadInstance));
+	}
+	else
+	{
+		SetInstanceAttributes(allocation.Offset);
+		DrawQuadsInstanced(s_InstanceCount, 0);
+	}
+
+	s_InstanceCount = 0;
+	s_TextureSlotCount = 0;
+	s_BatchFeatures = ShaderFeature_None;
+}
+
+void EndQuadBatch()
+{
+	FlushQuadBatch();
+}
+
+void ShutdownQuadBatch()
+{
+	glDeleteVertexArrays(1, &s_QuadVAO);
+
+	LSH_TRACE("Shutdown quad batch");
+}
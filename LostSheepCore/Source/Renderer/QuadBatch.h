@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Math/Types.h"
+
+#include <stdint.h>
+
+#define LSH_QUAD_BATCH_MAX_INSTANCES 4096
+#define LSH_QUAD_BATCH_MAX_TEXTURES 8
+
+// Per-instance data, layout must match the instance attributes of Rectangle.glsl and Texture.glsl
+typedef struct QuadInstance
+{
+	LSHVec3 Position;
+	LSHVec2 Size;
+	LSHVec4 Color;
+	float CornerRadius;
+	float BorderThickness;
+	int TextureSlot; // -1 for untextured quads
+} QuadInstance;
+
+// Uses the renderer's unit quad buffers for the per-vertex attributes
+void InitQuadBatch(uint32_t quadVBO, uint32_t quadIBO);
+
+void BeginQuadBatch();
+
+// Returns texture slot to be used by the quad, flushes the batch if all slots or instances are taken,
+// the quad has to be submitted right after so the slot is still bound when it is drawn
+int AcquireQuadBatchTextureSlot(uint32_t textureRendererID);
+
+// Text queued before a quad that blends is drawn first, so the quad is composited over it in command order
+void SubmitQuad(const QuadInstance* instance);
+
+// Issues one instanced draw for all queued quads
+void FlushQuadBatch();
+
+void EndQuadBatch();
+
+void ShutdownQuadBatch();
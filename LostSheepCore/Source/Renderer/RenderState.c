@@ -0,0 +1,193 @@
+#define LSH_LOG_CATEGORY LogCategory_Renderer
+
+#include "RenderState.h"
+
+#include "Core/Log.h"
+
+#include "glad/glad.h"
+
+#include <string.h>
+
+// Never a valid GL name, forces the next bind through
+#define LSH_RENDER_STATE_UNKNOWN 0xFFFFFFFFu
+
+typedef struct RenderStateCache
+{
+	uint32_t Program;
+	uint32_t VertexArray;
+	uint32_t ArrayBuffer;
+	uint32_t UniformBuffer;
+	uint32_t ActiveTextureUnit;
+	uint32_t Textures[LSH_RENDER_STATE_MAX_TEXTURE_UNITS];
+	int UnpackAlignment;
+} RenderStateCache;
+
+static RenderStateCache s_Cache;
+
+static RenderStateStats s_FrameStats;
+static RenderStateStats s_LastFrameStats;
+
+static int s_BaseInstanceSupported = 0;
+
+static void SetActiveTextureUnit(uint32_t unit)
+{
+	if (s_Cache.ActiveTextureUnit == unit)
+		return;
+
+	glActiveTexture(GL_TEXTURE0 + unit);
+	s_Cache.ActiveTextureUnit = unit;
+}
+
+void InitRenderState()
+{
+	s_BaseInstanceSupported = GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_base_instance;
+
+	InvalidateRenderState();
+
+	memset(&s_FrameStats, 0, sizeof(RenderStateStats));
+	memset(&s_LastFrameStats, 0, sizeof(RenderStateStats));
+
+	LSH_TRACE("Render state initialized, base instance: %s", s_BaseInstanceSupported ? "yes" : "no");
+}
+
+void InvalidateRenderState()
+{
+	s_Cache.Program = LSH_RENDER_STATE_UNKNOWN;
+	s_Cache.VertexArray = LSH_RENDER_STATE_UNKNOWN;
+	s_Cache.ArrayBuffer = LSH_RENDER_STATE_UNKNOWN;
+	s_Cache.UniformBuffer = LSH_RENDER_STATE_UNKNOWN;
+	s_Cache.ActiveTextureUnit = LSH_RENDER_STATE_UNKNOWN;
+	for (uint32_t i = 0; i < LSH_RENDER_STATE_MAX_TEXTURE_UNITS; i++)
+		s_Cache.Textures[i] = LSH_RENDER_STATE_UNKNOWN;
+	s_Cache.UnpackAlignment = -1;
+}
+
+void BeginRenderStateFrame()
+{
+	memset(&s_FrameStats, 0, sizeof(RenderStateStats));
+}
+
+void EndRenderStateFrame()
+{
+	s_LastFrameStats = s_FrameStats;
+}
+
+const RenderStateStats* GetRenderStateStats()
+{
+	return &s_LastFrameStats;
+}
+
+void BindProgram(uint32_t rendererID)
+{
+	if (s_Cache.Program == rendererID)
+	{
+		s_FrameStats.RedundantCalls++;
+		return;
+	}
+
+	glUseProgram(rendererID);
+	s_Cache.Program = rendererID;
+	s_FrameStats.ProgramBinds++;
+}
+
+void BindVertexArray(uint32_t rendererID)
+{
+	if (s_Cache.VertexArray == rendererID)
+	{
+		s_FrameStats.RedundantCalls++;
+		return;
+	}
+
+	glBindVertexArray(rendererID);
+	s_Cache.VertexArray = rendererID;
+	s_FrameStats.VertexArrayBinds++;
+}
+
+void BindBuffer(uint32_t target, uint32_t rendererID)
+{
+	uint32_t* cached = NULL;
+	if (target == GL_ARRAY_BUFFER)
+		cached = &s_Cache.ArrayBuffer;
+	else if (target == GL_UNIFORM_BUFFER)
+		cached = &s_Cache.UniformBuffer;
+
+	// Element buffer binding is part of the vertex array, it isn't cached
+	if (cached != NULL)
+	{
+		if (*cached == rendererID)
+		{
+			s_FrameStats.RedundantCalls++;
+			return;
+		}
+		*cached = rendererID;
+	}
+
+	glBindBuffer(target, rendererID);
+	s_FrameStats.BufferBinds++;
+}
+
+void BindUniformBufferBase(uint32_t binding, uint32_t rendererID)
+{
+	// Indexed bindings aren't cached, but they also replace the generic binding
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, rendererID);
+	s_Cache.UniformBuffer = rendererID;
+	s_FrameStats.BufferBinds++;
+}
+
+void BindTexture2D(uint32_t unit, uint32_t rendererID)
+{
+	if (unit >= LSH_RENDER_STATE_MAX_TEXTURE_UNITS)
+	{
+		LSH_ERROR("Texture unit %u is out of the tracked range", unit);
+		return;
+	}
+
+	if (s_Cache.Textures[unit] == rendererID)
+	{
+		s_FrameStats.RedundantCalls++;
+		return;
+	}
+
+	SetActiveTextureUnit(unit);
+	glBindTexture(GL_TEXTURE_2D, rendererID);
+	s_Cache.Textures[unit] = rendererID;
+	s_FrameStats.TextureBinds++;
+}
+
+void SetPixelUnpackAlignment(int alignment)
+{
+	if (s_Cache.UnpackAlignment == alignment)
+	{
+		s_FrameStats.RedundantCalls++;
+		return;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+	s_Cache.UnpackAlignment = alignment;
+}
+
+int IsBaseInstanceSupported()
+{
+	return s_BaseInstanceSupported;
+}
+
+void DrawQuadsInstanced(uint32_t instanceCount, uint32_t baseInstance)
+{
+	if (baseInstance > 0)
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)instanceCount, baseInstance);
+	else
+		glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)instanceCount);
+
+	s_FrameStats.DrawCalls++;
+	s_FrameStats.Instances += instanceCount;
+}
+
+void CountBufferUpload(uint64_t size)
+{
+	s_FrameStats.BytesUploaded += size;
+}
+
+void CountUniformUpload()
+{
+	s_FrameStats.UniformUploads++;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+
+// Matches the texture units tracked by the cache
+#define LSH_RENDER_STATE_MAX_TEXTURE_UNITS 16
+
+typedef struct RenderStateStats
+{
+	uint32_t ProgramBinds;
+	uint32_t VertexArrayBinds;
+	uint32_t BufferBinds;
+	uint32_t TextureBinds;
+	uint32_t DrawCalls;
+	uint32_t Instances;
+	uint32_t UniformUploads;
+	uint64_t BytesUploaded;
+	uint32_t RedundantCalls; // Skipped because the state was already set
+} RenderStateStats;
+
+void InitRenderState();
+
+// Forgets every cached binding, for when GL state was changed behind the cache or names were recycled
+void InvalidateRenderState();
+
+void BeginRenderStateFrame();
+
+void EndRenderStateFrame();
+
+// Counters of the last completed frame
+const RenderStateStats* GetRenderStateStats();
+
+void BindProgram(uint32_t rendererID);
+
+void BindVertexArray(uint32_t rendererID);
+
+// GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER are cached, other targets are passed through
+void BindBuffer(uint32_t target, uint32_t rendererID);
+
+void BindUniformBufferBase(uint32_t binding, uint32_t rendererID);
+
+void BindTexture2D(uint32_t unit, uint32_t rendererID);
+
+void SetPixelUnpackAlignment(int alignment);
+
+// GL 4.2 or ARB_base_instance, otherwise instance attributes have to be re-pointed per draw
+int IsBaseInstanceSupported();
+
+// Draws the bound unit quad, baseInstance must be 0 without base instance support
+void DrawQuadsInstanced(uint32_t instanceCount, uint32_t baseInstance);
+
+void CountBufferUpload(uint64_t size);
+
+void CountUniformUpload();
@@ -1,13 +1,23 @@
-﻿#include "Renderer.h"
+﻿#define LSH_LOG_CATEGORY LogCategory_Renderer
 
+#include "Renderer.h"
+
+#include "Core/FrameArena.h"
+#include "Core/FrameTimings.h"
 #include "Core/Log.h"
+#include "Core/Profiler.h"
 #include "Core/Window.h"
 
 #include "Event/Event.h"
 
 #include "Renderer/Shader.h"
+#include "Renderer/QuadBatch.h"
+#include "Renderer/RenderState.h"
+#include "Renderer/RendererStats.h"
+#include "Renderer/StreamBuffer.h"
 #include "Renderer/Texture.h"
 #include "Renderer/Text.h"
+#include "Renderer/TimeGraph.h"
 
 #include "UI/UI.h"
 
@@ -37,8 +47,8 @@ static unsigned int indices[] = {  // note that we start from 0!
 
 static unsigned int s_VAO;
 static unsigned int s_CommonVBO;
-static unsigned int s_TextVBO;
 static unsigned int s_IBO;
+static unsigned int s_FrameConstantsUBO;
 
 static float s_ZNear = -1000.0f;
 static float s_ZFar = 1000.0f;
@@ -47,6 +57,39 @@ static mat4 s_ProjectionMatrix;
 static mat4 s_ViewMatrix;
 static mat4 s_ViewProjectionMatrix;
 
+static FrameConstants s_FrameConstants;
+
+// Frames rendered regardless of the layout hash
+static int s_RedrawFrameCount = 0;
+static const int s_RedrawFramesOnRequest = 1;
+
+// Input may change hover and click state that only shows up in the next layout
+static const EventType s_RedrawEventTypes[] = {
+    EventTypeWindowRefresh,
+    EventTypeKeyPressed,
+    EventTypeKeyReleased,
+    EventTypeMouseButtonPressed,
+    EventTypeMouseButtonReleased,
+    EventTypeMouseMoved,
+    EventTypeMouseScrolled
+};
+
+static void UploadFrameConstants()
+{
+    const WindowData* windowData = GetWindowData();
+
+    glm_mat4_copy(s_ViewProjectionMatrix, s_FrameConstants.ViewProjection);
+    s_FrameConstants.ViewportSize = (LSHVec2){ (float)windowData->FramebufferWidth, (float)windowData->FramebufferHeight };
+    s_FrameConstants.Time = GetTimeWindow();
+    s_FrameConstants.DpiScale = GetContentScaleWindow();
+
+    // Respecifying the whole block orphans last frame's copy
+    BindBuffer(GL_UNIFORM_BUFFER, s_FrameConstantsUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), &s_FrameConstants, GL_DYNAMIC_DRAW);
+    CountBufferUpload(sizeof(FrameConstants));
+    BindUniformBufferBase(LSH_FRAME_CONSTANTS_BINDING, s_FrameConstantsUBO);
+}
+
 static int OnWindowResize(Event* event)
 {
     int width = ((int*)event->Data)[0];
@@ -55,26 +98,45 @@ static int OnWindowResize(Event* event)
     glm_ortho(0.0f, (float)width, (float)height, 0.0f, s_ZNear, s_ZFar, s_ProjectionMatrix);
     glm_mat4_mul(s_ProjectionMatrix, s_ViewMatrix, s_ViewProjectionMatrix);
 
-	glViewport(0, 0, width, height);
+    RequestRedrawRenderer();
+    return 0;
+}
+
+// The projection stays in screen coordinates, the viewport maps it onto the framebuffer pixels
+static int OnFramebufferResize(Event* event)
+{
+    int width = ((int*)event->Data)[0];
+    int height = ((int*)event->Data)[1];
+    glViewport(0, 0, width, height);
+
+    RequestRedrawRenderer();
+    return 0;
+}
+
+static int OnRedrawEvent(Event* event)
+{
+    RequestRedrawRenderer();
     return 0;
 }
 
 void InitRenderer()
 {
+    InitRenderState();
+
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
 
     glCreateVertexArrays(1, &s_VAO);
-    glBindVertexArray(s_VAO);
+    BindVertexArray(s_VAO);
 
     glGenBuffers(1, &s_IBO);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_IBO);
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_IBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
     glCreateBuffers(1, &s_CommonVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, s_CommonVBO);
+    BindBuffer(GL_ARRAY_BUFFER, s_CommonVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
@@ -82,31 +144,33 @@ void InitRenderer()
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
 
-    glCreateBuffers(1, &s_TextVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, s_TextVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), NULL, GL_DYNAMIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
+    glGenBuffers(1, &s_FrameConstantsUBO);
+    BindBuffer(GL_UNIFORM_BUFFER, s_FrameConstantsUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), NULL, GL_DYNAMIC_DRAW);
 
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 
-    BindCommonVBO();
-
     InitShader();
     InitTexture();
-    InitText();
+    InitStreamBuffer();
+    LSH_PROFILE_BEGIN("InitText");
+    InitText(s_CommonVBO, s_IBO);
+    LSH_PROFILE_END();
+    InitQuadBatch(s_CommonVBO, s_IBO);
 
 	const WindowData* windowData = GetWindowData();
-	glViewport(0, 0, windowData->Width, windowData->Height);
+	glViewport(0, 0, windowData->FramebufferWidth, windowData->FramebufferHeight);
     glm_mat4_identity(s_ViewMatrix);
     glm_ortho(0.0f, (float)windowData->Width, (float)windowData->Height, 0.0f, s_ZNear, s_ZFar, s_ProjectionMatrix);
 
 	glm_mat4_mul(s_ProjectionMatrix, s_ViewMatrix, s_ViewProjectionMatrix);
 
-	UploadUniformMat4f("uViewProjection", &s_ViewProjectionMatrix);
+    UploadFrameConstants();
+
+    SubscribeEvent(EventTypeWindowResize, OnWindowResize, EventPriorityRenderer);
+    SubscribeEvent(EventTypeFramebufferResize, OnFramebufferResize, EventPriorityRenderer);
+    for (uint32_t i = 0; i < sizeof(s_RedrawEventTypes) / sizeof(s_RedrawEventTypes[0]); i++)
+        SubscribeEvent(s_RedrawEventTypes[i], OnRedrawEvent, EventPriorityRenderer);
 
     InitUI();
 
@@ -116,73 +180,83 @@ void InitRenderer()
 void BeginRendering()
 {
     s_ZIndex = 0;
+    BeginFrameArena();
+    BeginRenderStateFrame();
+    BeginRendererStatsFrame();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-}
 
-void EndRendering()
-{
+    BeginStreamBufferFrame();
+    BeginQuadBatch();
+    BeginTextBatch();
 }
 
-void BindCommonVBO()
+void EndRendering()
 {
-    glBindBuffer(GL_ARRAY_BUFFER, s_CommonVBO);
+    // Remaining text comes after every queued quad in command order
+    EndQuadBatch();
+    EndTextBatch();
 
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
+    EndStreamBufferFrame();
+    EndRenderStateFrame();
 }
 
-void BindTextVBO()
+int OnUpdateRenderer(float deltaTime)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, s_TextVBO);
+    BeginFrameTimingZone(FrameTimingZone_Layout);
+    int layoutChanged = OnUpdateUI(deltaTime);
+    EndFrameTimingZone(FrameTimingZone_Layout);
+    if (!layoutChanged && s_RedrawFrameCount == 0)
+    {
+        // The skipped frame still ends, its layout allocations are not needed anymore
+        BeginFrameArena();
+        return 0;
+    }
 
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-}
+    if (s_RedrawFrameCount > 0)
+        s_RedrawFrameCount--;
 
-void OnUpdateRenderer(float deltaTime)
-{
     const WindowData* windowData = GetWindowData();
 
     glm_ortho(0.0f, (float)windowData->Width, (float)windowData->Height, 0.0f, s_ZNear, s_ZFar, s_ProjectionMatrix);
     glm_mat4_mul(s_ProjectionMatrix, s_ViewMatrix, s_ViewProjectionMatrix);
 
-    OnUpdateUI(deltaTime);
+    BeginFrameTimingZone(FrameTimingZone_Submit);
+    BeginRendering();
+    UploadFrameConstants();
+    RenderUI();
+    EndRendering();
+    EndFrameTimingZone(FrameTimingZone_Submit);
+
+    EndRendererStatsFrame();
+
+    return 1;
 }
 
-void OnEventRenderer(Event* event)
+void RequestRedrawRenderer()
 {
-	DispatchEvent(EventTypeWindowResize, event, OnWindowResize);
-    OnEventUI(event);
+    s_RedrawFrameCount = s_RedrawFramesOnRequest;
 }
 
 void RenderRectangle(Clay_RenderCommand* cmd)
 {
-    SetActiveShader(UIShaderType_Rectangle);
-
     Clay_BoundingBox bbox = cmd->boundingBox;
     Clay_RectangleRenderData rectangle = cmd->renderData.rectangle;
 
-    LSHVec3 position = { bbox.x, bbox.y, (float)s_ZIndex++ };
-
-    LSHVec4 color = {
-        rectangle.backgroundColor.r,
-        rectangle.backgroundColor.g,
-        rectangle.backgroundColor.b,
-        rectangle.backgroundColor.a
+    QuadInstance instance = {
+        .Position = { bbox.x, bbox.y, (float)s_ZIndex++ },
+        .Size = { bbox.width, bbox.height },
+        .Color = {
+            rectangle.backgroundColor.r,
+            rectangle.backgroundColor.g,
+            rectangle.backgroundColor.b,
+            rectangle.backgroundColor.a
+        },
+        .CornerRadius = rectangle.cornerRadius.topRight,
+        .BorderThickness = 0.0f,
+        .TextureSlot = -1
     };
 
-    UploadUniformMat4f("uViewProjection", &s_ViewProjectionMatrix);
-
-    UploadUniform3f("uQuadPos", &position);
-	UploadUniform2f("uQuadSize", &(LSHVec2) { bbox.width, bbox.height });
-    UploadUniform4f("uColor", &color);
-    UploadUniform1f("uCornerRadius", rectangle.cornerRadius.topRight);
-    UploadUniform1f("uBorderThickness", 0.0f);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    SubmitQuad(&instance);
 }
 
 void RenderRectangleRounded(Clay_RenderCommand* cmd)
@@ -191,45 +265,36 @@ void RenderRectangleRounded(Clay_RenderCommand* cmd)
 
 void RenderBorder(Clay_RenderCommand* cmd)
 {
-    SetActiveShader(UIShaderType_Rectangle);
-
     Clay_BoundingBox bbox = cmd->boundingBox;
     Clay_BorderRenderData border = cmd->renderData.border;
-    Clay_RectangleRenderData rectangle = cmd->renderData.rectangle;
-    
-    LSHVec3 position = { bbox.x, bbox.y, (float)s_ZIndex++ };
 
-	LSHVec4 color = { 1.0f, 0.0f, 1.0f, 0.0f };
+    QuadInstance instance = {
+        .Position = { bbox.x, bbox.y, (float)s_ZIndex++ },
+        .Size = { bbox.width, bbox.height },
+        .Color = { 1.0f, 0.0f, 1.0f, 0.0f },
+        .CornerRadius = border.cornerRadius.topRight,
+        .BorderThickness = border.width.top,
+        .TextureSlot = -1
+    };
 
-    if (rectangle.cornerRadius.topRight > 0.0f)
+    if (border.cornerRadius.topRight > 0.0f)
     {
-        color.r = border.color.r;
-        color.g = border.color.g;
-        color.b = border.color.b;
-        color.a = border.color.a;
+        instance.Color.r = border.color.r;
+        instance.Color.g = border.color.g;
+        instance.Color.b = border.color.b;
+        instance.Color.a = border.color.a;
     }
 
-    UploadUniformMat4f("uViewProjection", &s_ViewProjectionMatrix);
-
-    UploadUniform3f("uQuadPos", &position);
-    UploadUniform2f("uQuadSize", &(LSHVec2) { bbox.width, bbox.height });
-    UploadUniform4f("uColor", &color);
-    UploadUniform1f("uCornerRadius", rectangle.cornerRadius.topRight);
-    UploadUniform1f("uBorderThickness", border.width.top);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    SubmitQuad(&instance);
 }
 
 void RenderText(Clay_RenderCommand* cmd)
 {
-    SetActiveShader(UIShaderType_Text);
-
     Clay_BoundingBox bbox = cmd->boundingBox;
     Clay_TextRenderData textData = cmd->renderData.text;
     const char* text = textData.stringContents.chars;
 
-    LSHVec2 position = { 0.0f, 0.0f };
-    position.x = bbox.x;
-    position.y = bbox.y;
+    LSHVec3 position = { bbox.x, bbox.y, (float)s_ZIndex++ };
 
     LSHVec2 bboxDim = { 0.0f, 0.0f };
     bboxDim.x = bbox.width;
@@ -243,35 +308,26 @@ void RenderText(Clay_RenderCommand* cmd)
 
     //LSH_INFO(text);
 
-    UploadUniformMat4f("uViewProjection", &s_ViewProjectionMatrix);
-
-    UploadUniform1f("uQuadPosZ", (float)s_ZIndex++);
-
-    BindTextVBO();
     RenderTextLine(text, textData.stringContents.length, &position, &bboxDim, textData.fontSize, &color);
-    BindCommonVBO();
 }
 
 void RenderImage(Clay_RenderCommand* cmd)
 {
-    SetActiveShader(UIShaderType_Image);
-
     Clay_BoundingBox bbox = cmd->boundingBox;
     Clay_ImageRenderData image = cmd->renderData.image;
-    Clay_RectangleRenderData rectangle = cmd->renderData.rectangle;
-
-    LSHVec3 position = { bbox.x, bbox.y, (float)s_ZIndex++ };
 
-    int textureRendererID = *((TextureName*)(image.imageData));
-    BindActiveTexture(textureRendererID, 0);
+    uint32_t textureRendererID = GetTextureRendererID(*((TextureName*)(image.imageData)));
 
-    UploadUniformMat4f("uViewProjection", &s_ViewProjectionMatrix);
+    QuadInstance instance = {
+        .Position = { bbox.x, bbox.y, (float)s_ZIndex++ },
+        .Size = { bbox.width, bbox.height },
+        .Color = { 1.0f, 1.0f, 1.0f, 1.0f },
+        .CornerRadius = image.cornerRadius.topRight,
+        .BorderThickness = 0.0f,
+        .TextureSlot = AcquireQuadBatchTextureSlot(textureRendererID)
+    };
 
-    UploadUniform3f("uQuadPos", &position);
-    UploadUniform2f("uQuadSize", &(LSHVec2) { bbox.width, bbox.height });
-    //UploadUniform1i("uTexture", textureRendererID);
-    UploadUniform1f("uCornerRadius", rectangle.cornerRadius.topRight);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    SubmitQuad(&instance);
 }
 
 void StartClipping(Clay_RenderCommand* cmd)
@@ -284,11 +340,38 @@ void EndClipping(Clay_RenderCommand* cmd)
 
 void RenderCustomElement(Clay_RenderCommand* cmd)
 {
+    Clay_BoundingBox bbox = cmd->boundingBox;
+    Clay_CustomRenderData custom = cmd->renderData.custom;
+    if (custom.customData == NULL)
+        return;
+
+    switch (*(const CustomElementType*)custom.customData)
+    {
+    case CustomElementType_TimeGraph:
+    {
+        LSHVec4 backgroundColor = { custom.backgroundColor.r, custom.backgroundColor.g, custom.backgroundColor.b, custom.backgroundColor.a };
+        RenderTimeGraph(bbox.x, bbox.y, bbox.width, bbox.height, (float)s_ZIndex, &backgroundColor);
+        s_ZIndex += LSH_TIME_GRAPH_LAYERS;
+        break;
+    }
+    default:
+        break;
+    }
 }
 
 void ShutdownRenderer()
 {
+    ShutdownQuadBatch();
     ShutdownText();
+    ShutdownStreamBuffer();
+
+    glDeleteBuffers(1, &s_FrameConstantsUBO);
+
+    UnsubscribeEvent(EventTypeWindowResize, OnWindowResize);
+    UnsubscribeEvent(EventTypeFramebufferResize, OnFramebufferResize);
+    for (uint32_t i = 0; i < sizeof(s_RedrawEventTypes) / sizeof(s_RedrawEventTypes[0]); i++)
+        UnsubscribeEvent(s_RedrawEventTypes[i], OnRedrawEvent);
+
     ShutdownUI();
     ShutdownTexture();
     ShutdownShader();
@@ -4,19 +4,23 @@ typedef struct Clay_RenderCommand Clay_RenderCommand;
 
 typedef struct Event Event;
 
+// What customData of a Clay custom element points at
+typedef enum CustomElementType
+{
+    CustomElementType_TimeGraph
+} CustomElementType;
+
 void InitRenderer();
 
 void BeginRendering();
 
 void EndRendering();
 
-void BindCommonVBO();
-
-void BindTextVBO();
-
-void OnUpdateRenderer(float deltaTime);
+// Lays out the UI and renders it, returns 0 if the frame was skipped because nothing changed
+int OnUpdateRenderer(float deltaTime);
 
-void OnEventRenderer(Event* event);
+// Renders the next frames even if the layout didn't change
+void RequestRedrawRenderer();
 
 void RenderRectangle(Clay_RenderCommand* cmd);
 
@@ -0,0 +1,139 @@
+#define LSH_LOG_CATEGORY LogCategory_Renderer
+
+#include "RendererStats.h"
+
+#include "Core/FrameTimings.h"
+#include "Core/Log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static RendererStats s_FrameStats;
+static RendererStats s_History[LSH_RENDERER_STATS_HISTORY];
+static uint32_t s_FrameCount = 0;
+
+static const char* s_CommandTypeNames[RenderCommandType_Count] = {
+	"rectangle", "border", "text", "image", "scissor_start", "scissor_end", "custom"
+};
+
+void BeginRendererStatsFrame()
+{
+	memset(&s_FrameStats, 0, sizeof(RendererStats));
+}
+
+void CountRenderCommand(RenderCommandType type)
+{
+	s_FrameStats.Commands[type]++;
+	s_FrameStats.TotalCommands++;
+}
+
+void CountQuads(uint32_t count)
+{
+	s_FrameStats.Quads += count;
+}
+
+void CountGlyphs(uint32_t count)
+{
+	s_FrameStats.Glyphs += count;
+}
+
+void EndRendererStatsFrame()
+{
+	s_FrameStats.Frame = s_FrameCount;
+	s_FrameStats.State = *GetRenderStateStats();
+	s_FrameStats.LayoutMilliseconds = GetCurrentFrameTimingZone(FrameTimingZone_Layout);
+	s_FrameStats.SubmitMilliseconds = GetCurrentFrameTimingZone(FrameTimingZone_Submit);
+
+	s_History[s_FrameCount & (LSH_RENDERER_STATS_HISTORY - 1)] = s_FrameStats;
+	s_FrameCount++;
+}
+
+const RendererStats* GetRendererStats()
+{
+	if (s_FrameCount == 0)
+		return &s_FrameStats;
+
+	return &s_History[(s_FrameCount - 1) & (LSH_RENDERER_STATS_HISTORY - 1)];
+}
+
+uint32_t GetRendererStatsHistoryCount()
+{
+	return s_FrameCount < LSH_RENDERER_STATS_HISTORY ? s_FrameCount : LSH_RENDERER_STATS_HISTORY;
+}
+
+const RendererStats* GetRendererStatsHistory(uint32_t index)
+{
+	uint32_t oldest = s_FrameCount - GetRendererStatsHistoryCount();
+	return &s_History[(oldest + index) & (LSH_RENDERER_STATS_HISTORY - 1)];
+}
+
+const char* GetRenderCommandTypeName(RenderCommandType type)
+{
+	return type < RenderCommandType_Count ? s_CommandTypeNames[type] : "unknown";
+}
+
+int ExportRendererStatsCSV(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		LSH_ERROR("Failed to open %s, renderer stats are not exported", path);
+		return 0;
+	}
+
+	fprintf(file, "frame,layout_ms,submit_ms,commands");
+	for (int type = 0; type < RenderCommandType_Count; type++)
+		fprintf(file, ",%s", s_CommandTypeNames[type]);
+	fprintf(file, ",quads,glyphs,draw_calls,instances,program_binds,texture_binds,vertex_array_binds,buffer_binds,uniform_uploads,bytes_uploaded,redundant_calls\n");
+
+	uint32_t count = GetRendererStatsHistoryCount();
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const RendererStats* stats = GetRendererStatsHistory(i);
+		fprintf(file, "%u,%.3f,%.3f,%u", stats->Frame, stats->LayoutMilliseconds, stats->SubmitMilliseconds, stats->TotalCommands);
+		for (int type = 0; type < RenderCommandType_Count; type++)
+			fprintf(file, ",%u", stats->Commands[type]);
+		fprintf(file, ",%u,%u,%u,%u,%u,%u,%u,%u,%u,%llu,%u\n",
+			stats->Quads, stats->Glyphs, stats->State.DrawCalls, stats->State.Instances, stats->State.ProgramBinds,
+			stats->State.TextureBinds, stats->State.VertexArrayBinds, stats->State.BufferBinds, stats->State.UniformUploads,
+			(unsigned long long)stats->State.BytesUploaded, stats->State.RedundantCalls);
+	}
+
+	fclose(file);
+
+	LSH_INFO("Renderer stats of %u frames exported to %s", count, path);
+	return 1;
+}
+
+int ExportRendererStatsJSON(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		LSH_ERROR("Failed to open %s, renderer stats are not exported", path);
+		return 0;
+	}
+
+	fprintf(file, "{\"frames\":[\n");
+
+	uint32_t count = GetRendererStatsHistoryCount();
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const RendererStats* stats = GetRendererStatsHistory(i);
+		fprintf(file, "%s{\"frame\":%u,\"layout_ms\":%.3f,\"submit_ms\":%.3f,\"commands\":{\"total\":%u",
+			i > 0 ? ",\n" : "", stats->Frame, stats->LayoutMilliseconds, stats->SubmitMilliseconds, stats->TotalCommands);
+		for (int type = 0; type < RenderCommandType_Count; type++)
+			fprintf(file, ",\"%s\":%u", s_CommandTypeNames[type], stats->Commands[type]);
+		fprintf(file, "},\"quads\":%u,\"glyphs\":%u,\"draw_calls\":%u,\"instances\":%u,\"program_binds\":%u,\"texture_binds\":%u,"
+			"\"vertex_array_binds\":%u,\"buffer_binds\":%u,\"uniform_uploads\":%u,\"bytes_uploaded\":%llu,\"redundant_calls\":%u}",
+			stats->Quads, stats->Glyphs, stats->State.DrawCalls, stats->State.Instances, stats->State.ProgramBinds,
+			stats->State.TextureBinds, stats->State.VertexArrayBinds, stats->State.BufferBinds, stats->State.UniformUploads,
+			(unsigned long long)stats->State.BytesUploaded, stats->State.RedundantCalls);
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	LSH_INFO("Renderer stats of %u frames exported to %s", count, path);
+	return 1;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Renderer/RenderState.h"
+
+#include <stdint.h>
+
+// Rendered frames kept for export, power of two
+#define LSH_RENDERER_STATS_HISTORY 256
+
+// Clay render command types the renderer handles
+typedef enum RenderCommandType
+{
+	RenderCommandType_Rectangle,
+	RenderCommandType_Border,
+	RenderCommandType_Text,
+	RenderCommandType_Image,
+	RenderCommandType_ScissorStart,
+	RenderCommandType_ScissorEnd,
+	RenderCommandType_Custom,
+
+	RenderCommandType_Count
+} RenderCommandType;
+
+typedef struct RendererStats
+{
+	uint32_t Frame; // Index of the rendered frame, skipped frames are not counted
+	uint32_t Commands[RenderCommandType_Count];
+	uint32_t TotalCommands;
+	uint32_t Quads;
+	uint32_t Glyphs;
+	RenderStateStats State; // Draws, binds and uploads
+	float LayoutMilliseconds; // Clay layout including Clay_EndLayout
+	float SubmitMilliseconds; // CPU side of recording and issuing the GL calls
+} RendererStats;
+
+// Called at BeginRendering
+void BeginRendererStatsFrame();
+
+void CountRenderCommand(RenderCommandType type);
+
+void CountQuads(uint32_t count);
+
+void CountGlyphs(uint32_t count);
+
+// Called after the frame was submitted, takes the render state counters and the zone times
+void EndRendererStatsFrame();
+
+// Counters of the last rendered frame
+const RendererStats* GetRendererStats();
+
+uint32_t GetRendererStatsHistoryCount();
+
+// Index 0 is the oldest frame still kept
+const RendererStats* GetRendererStatsHistory(uint32_t index);
+
+const char* GetRenderCommandTypeName(RenderCommandType type);
+
+// One row or object per kept frame, oldest first
+int ExportRendererStatsCSV(const char* path);
+
+int ExportRendererStatsJSON(const char* path);
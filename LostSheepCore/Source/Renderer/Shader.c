@@ -1,6 +1,12 @@
+#define LSH_LOG_CATEGORY LogCategory_Renderer
+
 #include "Shader.h"
 
 #include "Core/Log.h"
+#include "Core/Profiler.h"
+#include "Core/Memory.h"
+
+#include "Renderer/RenderState.h"
 
 #include "glad/glad.h"
 
@@ -10,10 +16,19 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#ifdef LSH_PLATFORM_WINDOWS
+#include <direct.h>
+#define MakeDirectory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MakeDirectory(path) mkdir(path, 0755)
+#endif
+
 static Shader* s_Shaders[16];
 static uint32_t s_ShadersCount = 0;
 
 static Shader* s_ActiveShader = NULL;
+static ShaderVariant* s_ActiveVariant = NULL;
 
 // Must be in the serial of Rectangle, Image, Text; as UIShaderType enum
 static const char* s_ShadersPaths[] = {
@@ -24,7 +39,36 @@ static const char* s_ShadersPaths[] = {
 
 static uint32_t s_ShaderPathCount = 3;
 
-static char* ReadFile(const char* path)
+// Must be in the serial of s_ShadersPaths
+static const uint32_t s_ShaderSupportedFeatures[] = {
+	ShaderFeature_All,
+	ShaderFeature_All,
+	ShaderFeature_None
+};
+
+// Must be in the serial of the ShaderFeature bits
+static const char* s_ShaderFeatureDefines[] = {
+	"LSH_ROUNDED",
+	"LSH_BORDER"
+};
+
+static uint32_t s_ShaderFeatureCount = 2;
+
+// Program binaries are only valid for the driver that produced them
+static const char* s_ShaderCacheDirectory = "Cache/Shader";
+static const uint32_t s_ShaderCacheMagic = 0x4248534C; // "LSHB" in file byte order
+static const uint32_t s_ShaderCacheVersion = 1;
+
+typedef struct ShaderCacheHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t Hash;
+	uint32_t BinaryFormat;
+	uint32_t BinaryLength;
+} ShaderCacheHeader;
+
+static char* ReadFile(const char* path, size_t* size)
 {
 	char* buffer = NULL;
 	size_t string_size = 0, read_size = 0;
@@ -38,7 +82,7 @@ static char* ReadFile(const char* path)
 
 		if (string_size > 0)
 		{
-			buffer = (char*)malloc(sizeof(char) * (string_size + 1));
+			buffer = (char*)LSH_MALLOC(sizeof(char) * (string_size + 1), MemoryTag_Assets);
 			if (buffer != NULL)
 			{
 				read_size = (size_t)fread(buffer, sizeof(char), string_size, handler);
@@ -47,7 +91,7 @@ static char* ReadFile(const char* path)
 				if(read_size != string_size)
 				{
 					LSH_WARN("Could not read the entire file: %s", path);
-					free(buffer);
+					LSH_FREE(buffer);
 					buffer = NULL;
 				}
 			}
@@ -56,9 +100,159 @@ static char* ReadFile(const char* path)
 		fclose(handler);
 	}
 
+	if (size != NULL)
+		*size = buffer != NULL ? string_size : 0;
+
 	return buffer;
 }
 
+static uint64_t HashString(uint64_t hash, const char* string)
+{
+	// FNV-1a
+	if (string == NULL)
+		return hash;
+
+	while (*string)
+	{
+		hash ^= (unsigned char)(*string++);
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+static uint64_t HashShaderSource(const char* source, const char* defines)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	hash = HashString(hash, source);
+	hash = HashString(hash, defines);
+	hash = HashString(hash, (const char*)glGetString(GL_VENDOR));
+	hash = HashString(hash, (const char*)glGetString(GL_RENDERER));
+	hash = HashString(hash, (const char*)glGetString(GL_VERSION));
+	return hash;
+}
+
+static int IsProgramBinarySupported()
+{
+	int formatCount = 0;
+	if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	return formatCount > 0;
+}
+
+static void GetShaderCachePath(const char* path, uint32_t features, char* cachePath, size_t cachePathSize)
+{
+	const char* name = strrchr(path, '/');
+	name = name == NULL ? path : name + 1;
+	snprintf(cachePath, cachePathSize, "%s/%s.%u.bin", s_ShaderCacheDirectory, name, features);
+}
+
+static void BuildShaderDefines(uint32_t features, char* defines, size_t definesSize)
+{
+	defines[0] = '\0';
+	for (uint32_t i = 0; i < s_ShaderFeatureCount; i++)
+	{
+		if (features & (1u << i))
+		{
+			size_t length = strlen(defines);
+			snprintf(defines + length, definesSize - length, "#define %s\n", s_ShaderFeatureDefines[i]);
+		}
+	}
+}
+
+// State that isn't part of the program binary, set after every link or binary load
+static void OnProgramLinked(uint32_t program)
+{
+	uint32_t frameConstantsIndex = glGetUniformBlockIndex(program, "FrameConstants");
+	if (frameConstantsIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, frameConstantsIndex, LSH_FRAME_CONSTANTS_BINDING);
+}
+
+static uint32_t LoadProgramBinary(const char* path, uint32_t features, uint64_t hash)
+{
+	char cachePath[256];
+	GetShaderCachePath(path, features, cachePath, sizeof(cachePath));
+
+	size_t size = 0;
+	char* data = ReadFile(cachePath, &size);
+	if (data == NULL)
+		return 0;
+
+	const ShaderCacheHeader* header = (const ShaderCacheHeader*)data;
+	if (size < sizeof(ShaderCacheHeader) ||
+		header->Magic != s_ShaderCacheMagic ||
+		header->Version != s_ShaderCacheVersion ||
+		header->Hash != hash ||
+		size - sizeof(ShaderCacheHeader) < header->BinaryLength)
+	{
+		LSH_TRACE("Shader cache is stale: %s", cachePath);
+		LSH_FREE(data);
+		return 0;
+	}
+
+	uint32_t program = glCreateProgram();
+	glProgramBinary(program, header->BinaryFormat, data + sizeof(ShaderCacheHeader), (GLsizei)header->BinaryLength);
+	LSH_FREE(data);
+
+	// Drivers reject binaries from other driver versions here
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		LSH_TRACE("Shader cache rejected by driver: %s", cachePath);
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	OnProgramLinked(program);
+
+	return program;
+}
+
+static void SaveProgramBinary(const char* path, uint32_t features, uint64_t hash, uint32_t program)
+{
+	int binaryLength = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+		return;
+
+	char* data = (char*)LSH_MALLOC(sizeof(ShaderCacheHeader) + binaryLength, MemoryTag_Assets);
+	if (data == NULL)
+	{
+		LSH_ERROR("Failed to allocate memory for program binary");
+		return;
+	}
+
+	ShaderCacheHeader* header = (ShaderCacheHeader*)data;
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(program, binaryLength, NULL, &binaryFormat, data + sizeof(ShaderCacheHeader));
+
+	header->Magic = s_ShaderCacheMagic;
+	header->Version = s_ShaderCacheVersion;
+	header->Hash = hash;
+	header->BinaryFormat = binaryFormat;
+	header->BinaryLength = (uint32_t)binaryLength;
+
+	MakeDirectory("Cache");
+	MakeDirectory(s_ShaderCacheDirectory);
+
+	char cachePath[256];
+	GetShaderCachePath(path, features, cachePath, sizeof(cachePath));
+
+	FILE* handler = fopen(cachePath, "wb");
+	if (handler)
+	{
+		fwrite(data, 1, sizeof(ShaderCacheHeader) + binaryLength, handler);
+		fclose(handler);
+	}
+	else
+	{
+		LSH_WARN("Could not write shader cache: %s", cachePath);
+	}
+
+	LSH_FREE(data);
+}
+
 static Shader* GetShaderByUIShaderType(UIShaderType uiShaderType)
 {
 	return s_Shaders[uiShaderType];
@@ -79,50 +273,82 @@ static Shader* GetShaderByName(const char* name)
 	return NULL;
 }
 
-static int GetUniformLocation(const char* name)
+// Must be in the serial of ShaderUniform enum, array uniforms are named without the [0] suffix
+static const char* s_UniformNames[] = {
+	"uTextures",
+	"uTexture"
+};
+
+static void IntrospectUniforms(ShaderVariant* variant, const char* shaderName)
 {
-	uint32_t* uniformCount = &(s_ActiveShader->UniformCount);
-	UniformInfo* uniforms = s_ActiveShader->Uniforms;
-	for(uint32_t i = 0; i < *uniformCount; i++)
+	for (uint32_t i = 0; i < ShaderUniform_Count; i++)
+		variant->UniformLocations[i] = -1;
+
+	int activeUniformCount = 0;
+	glGetProgramiv(variant->RendererID, GL_ACTIVE_UNIFORMS, &activeUniformCount);
+
+	for (int i = 0; i < activeUniformCount; i++)
 	{
-		if (strcmp(uniforms[i].Name, name) == 0)
+		char name[64];
+		int nameLength = 0;
+		int size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(variant->RendererID, (GLuint)i, sizeof(name), &nameLength, &size, &type, name);
+
+		// Members of uniform blocks have no location
+		int location = glGetUniformLocation(variant->RendererID, name);
+		if (location == -1)
+			continue;
+
+		char* arraySuffix = strstr(name, "[0]");
+		if (arraySuffix != NULL)
+			*arraySuffix = '\0';
+
+		uint32_t uniform = 0;
+		for (; uniform < ShaderUniform_Count; uniform++)
 		{
-			return uniforms[i].Location;
+			if (strcmp(s_UniformNames[uniform], name) == 0)
+				break;
 		}
-	}
 
-	int location = glGetUniformLocation(s_ActiveShader->RendererID, name);
-	if (location == -1)
-	{
-		LSH_WARN("Could not find uniform: %s", name);
-		return -1;
-	}
+		if (uniform == ShaderUniform_Count)
+		{
+			LSH_WARN("Uniform %s of %s is not a ShaderUniform, it can't be uploaded", name, shaderName);
+			continue;
+		}
 
-	if (*uniformCount >= 16)
-	{
-		LSH_FATAL("Too many uniforms, increase the size of the Shader.Uniforms array");
-		return -1;
+		variant->UniformLocations[uniform] = location;
 	}
+}
 
-	UniformInfo* uniform = &(uniforms[*uniformCount]);
-	uniform->Location = location;
-	uniform->Name = _strdup(name);
-
-	if (uniform->Name == NULL)
+// Copies one stage, with the defines placed right after its #version line
+static char* CopyShaderStage(const char* stageSource, size_t stageLength, const char* defines)
+{
+	size_t definesLength = strlen(defines);
+	char* result = (char*)LSH_MALLOC(stageLength + definesLength + 1, MemoryTag_Assets);
+	if (result == NULL)
+		return NULL;
+
+	size_t headerLength = 0;
+	const char* version = strstr(stageSource, "#version");
+	if (version != NULL && (size_t)(version - stageSource) < stageLength)
 	{
-		LSH_FATAL("Failed to allocate memory for UniformInfo Name");
-		return -1;
+		const char* lineEnd = strchr(version, '\n');
+		headerLength = lineEnd != NULL ? (size_t)(lineEnd + 1 - stageSource) : stageLength;
+		if (headerLength > stageLength)
+			headerLength = stageLength;
 	}
 
-	(*uniformCount)++;
+	memcpy(result, stageSource, headerLength);
+	memcpy(result + headerLength, defines, definesLength);
+	memcpy(result + headerLength + definesLength, stageSource + headerLength, stageLength - headerLength);
+	result[stageLength + definesLength] = '\0';
 
-	return location;
+	return result;
 }
 
-static void ParseShader(const char* path, char** vertexSource, char** fragmentSource)
+static void ParseShader(const char* source, const char* defines, char** vertexSource, char** fragmentSource)
 {
-	const char* source = ReadFile(path);
-
 	const char* vertexToken = "#shader vertex";
 	const char* fragmentToken = "#shader fragment";
 	const char* vertexTokenLocation = strstr(source, vertexToken);
@@ -130,55 +356,23 @@ static void ParseShader(const char* path, char** vertexSource, char** fragmentSo
 	if (vertexTokenLocation == NULL || fragmentTokenLocation == NULL)
 	{
 		LSH_FATAL("Could not find shader tokens");
-		if (source)
-			free((void*)source);
 		*vertexSource = NULL;
 		*fragmentSource = NULL;
 		return;
 	}
 	size_t vertexSourceLength = fragmentTokenLocation - (vertexTokenLocation + strlen(vertexToken));
 	size_t fragmentSourceLength = strlen(source) - (fragmentTokenLocation - source) - strlen(fragmentToken);
-	*vertexSource = (char*)malloc(vertexSourceLength + 1);
-	*fragmentSource = (char*)malloc(fragmentSourceLength + 1);
-	if (*vertexSource != NULL)
-	{
-		memcpy(*vertexSource, vertexTokenLocation + strlen(vertexToken), vertexSourceLength);
-		(*vertexSource)[vertexSourceLength] = '\0';
-	}
-	if (*fragmentSource != NULL)
-	{
-		memcpy(*fragmentSource, fragmentTokenLocation + strlen(fragmentToken), fragmentSourceLength);
-		(*fragmentSource)[fragmentSourceLength] = '\0';
-	}
-
-	free((void*)source);
-}
-
-static void InvalidateUniforms(const char* shaderName)
-{
-	Shader* shader = GetShaderByName(shaderName);
-	if (shader == NULL)
-		return;
-
-	for(uint32_t i = 0; i < shader->UniformCount; i++)
-	{
-		free(shader->Uniforms[i].Name);
-	}
-	shader->UniformCount = 0;
+	*vertexSource = CopyShaderStage(vertexTokenLocation + strlen(vertexToken), vertexSourceLength, defines);
+	*fragmentSource = CopyShaderStage(fragmentTokenLocation + strlen(fragmentToken), fragmentSourceLength, defines);
 }
 
 void InitShader()
 {
+	LSH_PROFILE_BEGIN(__func__);
+
 	for (uint32_t i = 0; i < s_ShaderPathCount; i++)
 	{
-		uint32_t rendererID = CompileShader(s_ShadersPaths[i]);
-
-		if (rendererID <= 0)
-		{
-			LSH_FATAL("Failed to compile shader: %s", s_ShadersPaths[i]);
-			continue;
-		}
-		Shader* shader = (Shader*)malloc(sizeof(Shader));
+		Shader* shader = (Shader*)LSH_MALLOC(sizeof(Shader), MemoryTag_Renderer);
 		if (shader == NULL)
 		{
 			LSH_FATAL("Failed to allocate memory for Shader");
@@ -191,24 +385,44 @@ void InitShader()
 			name = path;
 		else
 			name++; // Skip the '/'
-		shader->Name = _strdup(name);
-		shader->Path = _strdup(path);
+		shader->Name = LSH_STRDUP(name, MemoryTag_Renderer);
+		shader->Path = LSH_STRDUP(path, MemoryTag_Renderer);
 		shader->uiShaderType = (UIShaderType)i;
-		shader->RendererID = rendererID;
-		shader->UniformCount = 0;
-		memset(shader->Uniforms, 0, sizeof(shader->Uniforms));
+		shader->SupportedFeatures = s_ShaderSupportedFeatures[i];
+
+		for (uint32_t features = 0; features < LSH_SHADER_VARIANT_COUNT; features++)
+		{
+			if (features & ~shader->SupportedFeatures)
+				continue;
+
+			ShaderVariant* variant = &shader->Variants[features];
+			LSH_PROFILE_BEGIN("CompileShader");
+			variant->RendererID = CompileShader(path, features);
+			LSH_PROFILE_END();
+			if (variant->RendererID == 0)
+			{
+				LSH_FATAL("Failed to compile shader: %s (features: %u)", path, features);
+				continue;
+			}
+
+			IntrospectUniforms(variant, shader->Name);
+		}
+
 		s_Shaders[s_ShadersCount] = shader;
 
 		s_ShadersCount++;
 
-		LSH_TRACE("Shader program compiled: %s", path);
+		LSH_TRACE("Shader program ready: %s", path);
 	}
 
 	s_ActiveShader = s_Shaders[0];
-	glUseProgram(s_ActiveShader->RendererID);
+	s_ActiveVariant = &s_ActiveShader->Variants[s_ActiveShader->SupportedFeatures];
+	BindProgram(s_ActiveVariant->RendererID);
+
+	LSH_PROFILE_END();
 }
 
-uint32_t CompileShader(const char* path)
+uint32_t CompileShader(const char* path, uint32_t features)
 {
 	char* vertexSource = NULL;
 	char* fragmentSource = NULL;
@@ -216,7 +430,32 @@ uint32_t CompileShader(const char* path)
 	uint32_t vertexShader;
 	uint32_t fragmentShader;
 
-	ParseShader(path, &vertexSource, &fragmentSource);
+	char* source = ReadFile(path, NULL);
+	if (source == NULL)
+	{
+		LSH_FATAL("Could not read shader: %s", path);
+		return 0;
+	}
+
+	char defines[256];
+	BuildShaderDefines(features, defines, sizeof(defines));
+
+	int useProgramBinary = IsProgramBinarySupported();
+	uint64_t hash = HashShaderSource(source, defines);
+
+	if (useProgramBinary)
+	{
+		uint32_t cachedProgram = LoadProgramBinary(path, features, hash);
+		if (cachedProgram != 0)
+		{
+			LSH_TRACE("Shader program loaded from cache: %s (features: %u)", path, features);
+			LSH_FREE(source);
+			return cachedProgram;
+		}
+	}
+
+	ParseShader(source, defines, &vertexSource, &fragmentSource);
+	LSH_FREE(source);
 
 	//LSH_TRACE("Vertex Shader Source:\n%s", vertexSource);
 	//LSH_TRACE("Fragment Shader Source:\n%s", fragmentSource);
@@ -224,6 +463,8 @@ uint32_t CompileShader(const char* path)
 	if (vertexSource == NULL || fragmentSource == NULL)
 	{
 		LSH_FATAL("Failed to load shader sources");
+		LSH_FREE(vertexSource);
+		LSH_FREE(fragmentSource);
 		return 0;
 	}
 
@@ -239,6 +480,9 @@ uint32_t CompileShader(const char* path)
 		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
 		LSH_ERROR("SHADER::VERTEX::COMPILATION_FAILED, %s", infoLog);
 
+		glDeleteShader(vertexShader);
+		LSH_FREE(vertexSource);
+		LSH_FREE(fragmentSource);
 		return 0;
 	}
 
@@ -252,22 +496,42 @@ uint32_t CompileShader(const char* path)
 		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
 		LSH_ERROR("SHADER::FRAGMENT::COMPILATION_FAILED, %s", infoLog);
 
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		LSH_FREE(vertexSource);
+		LSH_FREE(fragmentSource);
 		return 0;
 	}
 
 	uint32_t shaderProgram = glCreateProgram();
 
+	if (useProgramBinary)
+		glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	glAttachShader(shaderProgram, vertexShader);
 	glAttachShader(shaderProgram, fragmentShader);
 	glLinkProgram(shaderProgram);
 
-	glUseProgram(shaderProgram);
-
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 
-	free(vertexSource);
-	free(fragmentSource);
+	LSH_FREE(vertexSource);
+	LSH_FREE(fragmentSource);
+
+	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+		LSH_ERROR("SHADER::PROGRAM::LINKING_FAILED, %s", infoLog);
+		glDeleteProgram(shaderProgram);
+
+		return 0;
+	}
+
+	OnProgramLinked(shaderProgram);
+
+	if (useProgramBinary)
+		SaveProgramBinary(path, features, hash, shaderProgram);
 
 	return shaderProgram;
 }
@@ -280,113 +544,174 @@ int RecompileShader(const char* name)
 		LSH_ERROR("Could not find shader to recompile: %s", name);
 		return 0;
 	}
-	uint32_t newRendererID = CompileShader(shader->Path);
-	if (newRendererID == 0)
+
+	// Keep every old variant unless all of them compile
+	uint32_t newRendererIDs[LSH_SHADER_VARIANT_COUNT] = { 0 };
+	for (uint32_t features = 0; features < LSH_SHADER_VARIANT_COUNT; features++)
 	{
-		LSH_ERROR("Failed to recompile shader: %s", name);
-		return 0;
+		if (features & ~shader->SupportedFeatures)
+			continue;
+
+		newRendererIDs[features] = CompileShader(shader->Path, features);
+		if (newRendererIDs[features] == 0)
+		{
+			LSH_ERROR("Failed to recompile shader: %s (features: %u)", name, features);
+			for (uint32_t i = 0; i < features; i++)
+			{
+				if (newRendererIDs[i] != 0)
+					glDeleteProgram(newRendererIDs[i]);
+			}
+			return 0;
+		}
+	}
+
+	for (uint32_t features = 0; features < LSH_SHADER_VARIANT_COUNT; features++)
+	{
+		if (newRendererIDs[features] == 0)
+			continue;
+
+		ShaderVariant* variant = &shader->Variants[features];
+		if (variant->RendererID != 0)
+			glDeleteProgram(variant->RendererID);
+		variant->RendererID = newRendererIDs[features];
+		IntrospectUniforms(variant, shader->Name);
 	}
-	shader->RendererID = newRendererID;
+
+	if (s_ActiveShader == shader)
+		BindProgram(s_ActiveVariant->RendererID);
+
 	return 1;
 }
 
 void SetActiveShader(UIShaderType uiShaderType)
 {
-	if(s_ActiveShader->uiShaderType != uiShaderType)
+	SetActiveShaderVariant(uiShaderType, ShaderFeature_All);
+}
+
+void SetActiveShaderVariant(UIShaderType uiShaderType, uint32_t features)
+{
+	Shader* shader = GetShaderByUIShaderType(uiShaderType);
+	ShaderVariant* variant = &shader->Variants[features & shader->SupportedFeatures];
+
+	// Fall back to the full variant if this one failed to compile
+	if (variant->RendererID == 0)
+		variant = &shader->Variants[shader->SupportedFeatures];
+
+	if (s_ActiveVariant != variant)
 	{
-		Shader* shader = GetShaderByUIShaderType(uiShaderType);
-		glUseProgram(shader->RendererID);
+		BindProgram(variant->RendererID);
 		s_ActiveShader = shader;
+		s_ActiveVariant = variant;
 	}
 }
 
-void UploadUniform1i(const char* name, int value)
+void UploadUniform1i(ShaderUniform uniform, int value)
 {
-    int location = GetUniformLocation(name);
+    int location = s_ActiveVariant->UniformLocations[uniform];
     if (location != -1)
     {
         glUniform1i(location, (GLint)value);
+        CountUniformUpload();
     }
 }
 
-void UploadUniform2i(const char* name, const LSHIVec2* value)
+void UploadUniform2i(ShaderUniform uniform, const LSHIVec2* value)
 {
-    int location = GetUniformLocation(name);
+    int location = s_ActiveVariant->UniformLocations[uniform];
     if (location != -1)
     {
         glUniform2i(location, (GLint)(value->x), (GLint)(value->y));
+        CountUniformUpload();
     }
 }
 
-void UploadUniform3i(const char* name, const LSHIVec3* value)
+void UploadUniform3i(ShaderUniform uniform, const LSHIVec3* value)
 {
-    int location = GetUniformLocation(name);
+    int location = s_ActiveVariant->UniformLocations[uniform];
     if (location != -1)
     {
         glUniform3i(location, (GLint)(value->x), (GLint)(value->y), (GLint)(value->z));
+        CountUniformUpload();
     }
 }
 
-void UploadUniform4i(const char* name, const LSHIVec4* value)
+void UploadUniform4i(ShaderUniform uniform, const LSHIVec4* value)
 {
-	int location = GetUniformLocation(name);
+	int location = s_ActiveVariant->UniformLocations[uniform];
 	if (location != -1)
 	{
 		glUniform4i(location, (GLint)(value->x), (GLint)(value->y), (GLint)(value->z), (GLint)(value->w));
+		CountUniformUpload();
+	}
+}
+
+void UploadUniform1iv(ShaderUniform uniform, const int* values, uint32_t count)
+{
+	int location = s_ActiveVariant->UniformLocations[uniform];
+	if (location != -1)
+	{
+		glUniform1iv(location, (GLsizei)count, (const GLint*)values);
+		CountUniformUpload();
 	}
 }
 
-void UploadUniform1f(const char* name, float value)
+void UploadUniform1f(ShaderUniform uniform, float value)
 {
-	int location = GetUniformLocation(name);
+	int location = s_ActiveVariant->UniformLocations[uniform];
 	if (location != -1)
 	{
 		glUniform1f(location, (GLfloat)value);
+		CountUniformUpload();
 	}
 }
 
-void UploadUniform2f(const char* name, const LSHVec2* value)
+void UploadUniform2f(ShaderUniform uniform, const LSHVec2* value)
 {
-	int location = GetUniformLocation(name);
+	int location = s_ActiveVariant->UniformLocations[uniform];
 	if (location != -1)
 	{
 		glUniform2f(location, (GLfloat)(value->x), (GLfloat)(value->y));
+		CountUniformUpload();
 	}
 }
 
-void UploadUniform3f(const char* name, const LSHVec3* value)
+void UploadUniform3f(ShaderUniform uniform, const LSHVec3* value)
 {
-	int location = GetUniformLocation(name);
+	int location = s_ActiveVariant->UniformLocations[uniform];
 	if (location != -1)
 	{
 		glUniform3f(location, (GLfloat)(value->x), (GLfloat)(value->y), (GLfloat)(value->z));
+		CountUniformUpload();
 	}
 }
 
-void UploadUniform4f(const char* name, const LSHVec4* value)
+void UploadUniform4f(ShaderUniform uniform, const LSHVec4* value)
 {
-	int location = GetUniformLocation(name);
+	int location = s_ActiveVariant->UniformLocations[uniform];
 	if (location != -1)
 	{
 		glUniform4f(location, (GLfloat)(value->x), (GLfloat)(value->y), (GLfloat)(value->z), (GLfloat)(value->w));
+		CountUniformUpload();
 	}
 }
 
-void UploadUniformMat3f(const char* name, const mat3* matrix)
+void UploadUniformMat3f(ShaderUniform uniform, const mat3* matrix)
 {
-	int location = GetUniformLocation(name);
+	int location = s_ActiveVariant->UniformLocations[uniform];
 	if (location != -1)
 	{
 		glUniformMatrix3fv(location, 1, GL_FALSE, (const GLfloat*)matrix);
+		CountUniformUpload();
 	}
 }
 
-void UploadUniformMat4f(const char* name, const mat4* matrix)
+void UploadUniformMat4f(ShaderUniform uniform, const mat4* matrix)
 {
-	int location = GetUniformLocation(name);
+	int location = s_ActiveVariant->UniformLocations[uniform];
 	if (location != -1)
 	{
 		glUniformMatrix4fv(location, 1, GL_FALSE, (const GLfloat*)matrix);
+		CountUniformUpload();
 	}
 }
 
@@ -396,14 +721,14 @@ void ShutdownShader()
 	{
 		if (s_Shaders[i] == NULL)
 			continue;
-		glDeleteProgram(s_Shaders[i]->RendererID);
-		free(s_Shaders[i]->Name);
-		free(s_Shaders[i]->Path);
-		for(uint32_t j = 0; j < s_Shaders[i]->UniformCount; j++)
+		for (uint32_t j = 0; j < LSH_SHADER_VARIANT_COUNT; j++)
 		{
-			free(s_Shaders[i]->Uniforms[j].Name);
+			if (s_Shaders[i]->Variants[j].RendererID != 0)
+				glDeleteProgram(s_Shaders[i]->Variants[j].RendererID);
 		}
-		free(s_Shaders[i]);
+		LSH_FREE(s_Shaders[i]->Name);
+		LSH_FREE(s_Shaders[i]->Path);
+		LSH_FREE(s_Shaders[i]);
 	}
 
 	LSH_TRACE("Shutdown shader");
@@ -14,11 +14,47 @@ typedef enum UIShaderType
 
 } UIShaderType;
 
-typedef struct UniformInfo
+// Uniform block binding point of the FrameConstants block
+#define LSH_FRAME_CONSTANTS_BINDING 0
+
+// std140 layout of the FrameConstants uniform block
+typedef struct FrameConstants
 {
-	char* Name;
-	int Location;
-} UniformInfo;
+	mat4 ViewProjection;
+	LSHVec2 ViewportSize; // Framebuffer pixels, the projection is in screen coordinates
+	float Time;
+	float DpiScale;
+} FrameConstants;
+
+// Every uniform used by the UI programs, resolved to a location per program at link time
+typedef enum ShaderUniform
+{
+	ShaderUniform_Textures = 0,
+	ShaderUniform_Texture,
+
+	ShaderUniform_Count
+} ShaderUniform;
+
+// Compile-time specializations, injected as #defines after the #version line
+typedef enum ShaderFeature
+{
+	ShaderFeature_None = 0,
+	ShaderFeature_Rounded = 1 << 0, // LSH_ROUNDED: anti-aliased rounded rect edges
+	ShaderFeature_Border = 1 << 1, // LSH_BORDER: border ring
+
+	ShaderFeature_All = ShaderFeature_Rounded | ShaderFeature_Border
+} ShaderFeature;
+
+#define LSH_SHADER_VARIANT_COUNT (ShaderFeature_All + 1)
+
+typedef struct ShaderVariant
+{
+	// 0 for feature sets the shader doesn't support
+	uint32_t RendererID;
+
+	// -1 for uniforms the program doesn't use
+	int UniformLocations[ShaderUniform_Count];
+} ShaderVariant;
 
 typedef struct Shader
 {
@@ -26,30 +62,34 @@ typedef struct Shader
 	char* Path;
 	UIShaderType uiShaderType;
 
-	uint32_t UniformCount;
-	UniformInfo Uniforms[16];
-
-	uint32_t RendererID;
+	// Every subset of these features is compiled up front, indexed by the ShaderFeature bits
+	uint32_t SupportedFeatures;
+	ShaderVariant Variants[LSH_SHADER_VARIANT_COUNT];
 } Shader;
 
 void InitShader();
 
-uint32_t CompileShader(const char* path);
+uint32_t CompileShader(const char* path, uint32_t features);
 int RecompileShader(const char* name);
 
+// Binds the variant with all supported features
 void SetActiveShader(UIShaderType uiShaderType);
 
-void UploadUniform1i(const char* name, int v0);
-void UploadUniform2i(const char* name, const LSHIVec2* v0);
-void UploadUniform3i(const char* name, const LSHIVec3* v0);
-void UploadUniform4i(const char* name, const LSHIVec4* v0);
+// Binds the cheapest variant that covers the features
+void SetActiveShaderVariant(UIShaderType uiShaderType, uint32_t features);
+
+void UploadUniform1i(ShaderUniform uniform, int v0);
+void UploadUniform2i(ShaderUniform uniform, const LSHIVec2* v0);
+void UploadUniform3i(ShaderUniform uniform, const LSHIVec3* v0);
+void UploadUniform4i(ShaderUniform uniform, const LSHIVec4* v0);
+void UploadUniform1iv(ShaderUniform uniform, const int* values, uint32_t count);
 
-void UploadUniform1f(const char* name, float v0);
-void UploadUniform2f(const char* name, const LSHVec2* v0);
-void UploadUniform3f(const char* name, const LSHVec3* v0);
-void UploadUniform4f(const char* name, const LSHVec4* v0);
+void UploadUniform1f(ShaderUniform uniform, float v0);
+void UploadUniform2f(ShaderUniform uniform, const LSHVec2* v0);
+void UploadUniform3f(ShaderUniform uniform, const LSHVec3* v0);
+void UploadUniform4f(ShaderUniform uniform, const LSHVec4* v0);
 
-void UploadUniformMat3f(const char* name, const mat3* matrix);
-void UploadUniformMat4f(const char* name, const mat4* matrix);
+void UploadUniformMat3f(ShaderUniform uniform, const mat3* matrix);
+void UploadUniformMat4f(ShaderUniform uniform, const mat4* matrix);
 
 void ShutdownShader();
\ No newline at end of file
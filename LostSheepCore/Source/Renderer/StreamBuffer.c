@@ -0,0 +1,203 @@
+#define LSH_LOG_CATEGORY LogCategory_Renderer
+
+#include "StreamBuffer.h"
+
+#include "Core/Log.h"
+
+#include "Renderer/RenderState.h"
+
+#include "glad/glad.h"
+
+#include <stddef.h>
+
+#define LSH_STREAM_BUFFER_SIZE (LSH_STREAM_BUFFER_SEGMENT_SIZE * LSH_STREAM_BUFFER_SEGMENT_COUNT)
+
+static uint32_t s_RendererID = 0;
+
+// Persistent mapping needs GL 4.4 or ARB_buffer_storage
+static int s_IsPersistent = 0;
+static char* s_MappedData = NULL;
+
+static GLsync s_SegmentFences[LSH_STREAM_BUFFER_SEGMENT_COUNT];
+static uint32_t s_SegmentIndex = 0;
+static uint32_t s_SegmentHead = 0;
+
+static void WaitForSegment(uint32_t segmentIndex)
+{
+	GLsync fence = s_SegmentFences[segmentIndex];
+	if (fence == NULL)
+		return;
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+	}
+
+	if (result == GL_WAIT_FAILED)
+		LSH_ERROR("Stream buffer fence wait failed");
+
+	glDeleteSync(fence);
+	s_SegmentFences[segmentIndex] = NULL;
+}
+
+// Only the persistent mapping waits on fences. The unsynchronized path writes each segment once per
+// orphaned storage, the wrap hands the GPU's copy off to the driver, so a fence there is pure overhead
+static void FenceSegment(uint32_t segmentIndex)
+{
+	if (!s_IsPersistent)
+		return;
+
+	if (s_SegmentFences[segmentIndex] != NULL)
+		glDeleteSync(s_SegmentFences[segmentIndex]);
+
+	s_SegmentFences[segmentIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static void AdvanceSegment()
+{
+	s_SegmentIndex = (s_SegmentIndex + 1) % LSH_STREAM_BUFFER_SEGMENT_COUNT;
+	s_SegmentHead = 0;
+
+	if (s_IsPersistent)
+	{
+		WaitForSegment(s_SegmentIndex);
+	}
+	else if (s_SegmentIndex == 0)
+	{
+		// Orphan on wrap, the driver hands out fresh storage instead of waiting on the old one
+		BindBuffer(GL_ARRAY_BUFFER, s_RendererID);
+		glBufferData(GL_ARRAY_BUFFER, LSH_STREAM_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+	}
+}
+
+void InitStreamBuffer()
+{
+	glGenBuffers(1, &s_RendererID);
+	BindBuffer(GL_ARRAY_BUFFER, s_RendererID);
+
+	s_IsPersistent = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+
+	if (s_IsPersistent)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, LSH_STREAM_BUFFER_SIZE, NULL, flags);
+		s_MappedData = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, LSH_STREAM_BUFFER_SIZE, flags);
+
+		if (s_MappedData == NULL)
+		{
+			LSH_WARN("Failed to persistently map stream buffer, falling back to unsynchronized mapping");
+			glDeleteBuffers(1, &s_RendererID);
+			glGenBuffers(1, &s_RendererID);
+
+			// The new buffer may reuse the deleted name
+			InvalidateRenderState();
+			BindBuffer(GL_ARRAY_BUFFER, s_RendererID);
+			s_IsPersistent = 0;
+		}
+	}
+
+	if (!s_IsPersistent)
+	{
+		glBufferData(GL_ARRAY_BUFFER, LSH_STREAM_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+	}
+
+	for (uint32_t i = 0; i < LSH_STREAM_BUFFER_SEGMENT_COUNT; i++)
+		s_SegmentFences[i] = NULL;
+
+	s_SegmentIndex = 0;
+	s_SegmentHead = 0;
+
+	LSH_TRACE("Stream buffer initialized: %u KiB, %s", LSH_STREAM_BUFFER_SIZE / 1024, s_IsPersistent ? "persistent" : "unsynchronized");
+}
+
+uint32_t GetStreamBufferRendererID()
+{
+	return s_RendererID;
+}
+
+void BeginStreamBufferFrame()
+{
+	AdvanceSegment();
+}
+
+StreamAllocation AllocateStreamBuffer(uint32_t size, uint32_t alignment)
+{
+	StreamAllocation allocation = { NULL, 0, 0 };
+
+	if (alignment == 0)
+		alignment = 1;
+
+	if (size + alignment > LSH_STREAM_BUFFER_SEGMENT_SIZE)
+	{
+		LSH_ERROR("Stream allocation of %u bytes is bigger than a segment", size);
+		return allocation;
+	}
+
+	// Alignment doesn't have to be a power of two, instance strides are used directly.
+	// Offsets are aligned from the start of the buffer so they can be used as a base instance
+	uint32_t segmentStart = s_SegmentIndex * LSH_STREAM_BUFFER_SEGMENT_SIZE;
+	uint32_t offset = ((segmentStart + s_SegmentHead + alignment - 1) / alignment) * alignment;
+	if (offset + size > segmentStart + LSH_STREAM_BUFFER_SEGMENT_SIZE)
+	{
+		// Out of room this frame, fence what was written and move on to the next segment
+		FenceSegment(s_SegmentIndex);
+		AdvanceSegment();
+		segmentStart = s_SegmentIndex * LSH_STREAM_BUFFER_SEGMENT_SIZE;
+		offset = ((segmentStart + alignment - 1) / alignment) * alignment;
+	}
+
+	s_SegmentHead = offset - segmentStart + size;
+	CountBufferUpload(size);
+
+	allocation.Offset = offset;
+	allocation.Size = size;
+
+	if (s_IsPersistent)
+	{
+		allocation.Data = s_MappedData + offset;
+	}
+	else
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		BindBuffer(GL_ARRAY_BUFFER, s_RendererID);
+		allocation.Data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, flags);
+	}
+
+	return allocation;
+}
+
+void CommitStreamBuffer(const StreamAllocation* allocation)
+{
+	// Coherent persistent mappings are visible to the GPU without an explicit flush
+	if (s_IsPersistent || allocation->Data == NULL)
+		return;
+
+	BindBuffer(GL_ARRAY_BUFFER, s_RendererID);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+void EndStreamBufferFrame()
+{
+	FenceSegment(s_SegmentIndex);
+}
+
+void ShutdownStreamBuffer()
+{
+	for (uint32_t i = 0; i < LSH_STREAM_BUFFER_SEGMENT_COUNT; i++)
+	{
+		if (s_SegmentFences[i] != NULL)
+			glDeleteSync(s_SegmentFences[i]);
+		s_SegmentFences[i] = NULL;
+	}
+
+	if (s_IsPersistent)
+	{
+		BindBuffer(GL_ARRAY_BUFFER, s_RendererID);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+
+	glDeleteBuffers(1, &s_RendererID);
+
+	LSH_TRACE("Shutdown stream buffer");
+}
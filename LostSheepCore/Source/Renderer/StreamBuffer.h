@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+// One segment per frame in flight, a persistent segment is only rewritten after its fence has signaled,
+// without persistent mapping the buffer is orphaned when the segments wrap instead
+#define LSH_STREAM_BUFFER_SEGMENT_SIZE (2 * 1024 * 1024)
+#define LSH_STREAM_BUFFER_SEGMENT_COUNT 3
+
+typedef struct StreamAllocation
+{
+	void* Data;
+	uint32_t Offset; // Byte offset into the stream buffer, a multiple of the alignment
+	uint32_t Size;
+} StreamAllocation;
+
+void InitStreamBuffer();
+
+uint32_t GetStreamBufferRendererID();
+
+// Waits for the GPU to release the segment of this frame, or orphans the buffer on wrap
+void BeginStreamBufferFrame();
+
+// Data is NULL if the allocation can't fit in a segment
+StreamAllocation AllocateStreamBuffer(uint32_t size, uint32_t alignment);
+
+// Must be called before the allocation is drawn from
+void CommitStreamBuffer(const StreamAllocation* allocation);
+
+// Fences the segment written this frame when persistently mapped
+void EndStreamBufferFrame();
+
+void ShutdownStreamBuffer();
@@ -1,11 +1,22 @@
+#define LSH_LOG_CATEGORY LogCategory_Text
+
 #include "Text.h"
 
 #include "Core/Log.h"
+#include "Core/Profiler.h"
+#include "Core/Memory.h"
 
+#include "Renderer/RenderState.h"
+#include "Renderer/RendererStats.h"
 #include "Renderer/Shader.h"
+#include "Renderer/StreamBuffer.h"
 
 #include "glad/glad.h"
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
 // Thanks to https://learnopengl.com/In-Practice/Text-Rendering
 
 #include "ft2build.h"
@@ -23,7 +34,128 @@ static float s_TextSizeAdj = 1.0f;
 
 static TextCharacter s_Characters[128];
 
-void InitText()
+static uint32_t s_AtlasRendererID = 0;
+static int s_AtlasPadding = 1;
+
+static uint32_t s_TextVAO;
+
+static GlyphInstance s_Glyphs[LSH_TEXT_BATCH_MAX_GLYPHS];
+static uint32_t s_GlyphCount = 0;
+
+// Glyphs live in the stream buffer, attributes are only re-pointed per flush without base instance support
+static void SetGlyphAttributes(uint32_t baseOffset)
+{
+    BindBuffer(GL_ARRAY_BUFFER, GetStreamBufferRendererID());
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (void*)(baseOffset + offsetof(GlyphInstance, Position)));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (void*)(baseOffset + offsetof(GlyphInstance, Size)));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (void*)(baseOffset + offsetof(GlyphInstance, AtlasUV)));
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (void*)(baseOffset + offsetof(GlyphInstance, Color)));
+}
+
+static uint32_t NextPowerOfTwo(uint32_t value)
+{
+    uint32_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+// Shelf packs the glyph bitmaps into a single row-major R8 atlas
+static void BuildGlyphAtlas()
+{
+    LSHIVec2 glyphOffsets[128];
+    int penX = s_AtlasPadding;
+    int penY = s_AtlasPadding;
+    int shelfHeight = 0;
+
+    // First pass, only the metrics are needed to lay out the atlas
+    for (unsigned char c = 0; c < 128; c++)
+    {
+        if (FT_Load_Char(s_Face, c, FT_LOAD_RENDER))
+        {
+            LSH_ERROR("FREETYTPE: Failed to load Glyph");
+            glyphOffsets[c] = (LSHIVec2){ -1, -1 };
+            continue;
+        }
+
+        FT_Bitmap* bitmap = &s_Face->glyph->bitmap;
+        if (penX + (int)bitmap->width + s_AtlasPadding > LSH_TEXT_ATLAS_WIDTH)
+        {
+            penX = s_AtlasPadding;
+            penY += shelfHeight + s_AtlasPadding;
+            shelfHeight = 0;
+        }
+
+        glyphOffsets[c] = (LSHIVec2){ penX, penY };
+        penX += (int)bitmap->width + s_AtlasPadding;
+        if ((int)bitmap->rows > shelfHeight)
+            shelfHeight = (int)bitmap->rows;
+    }
+
+    int atlasHeight = (int)NextPowerOfTwo((uint32_t)(penY + shelfHeight + s_AtlasPadding));
+    unsigned char* pixels = (unsigned char*)LSH_CALLOC((size_t)LSH_TEXT_ATLAS_WIDTH * atlasHeight, 1, MemoryTag_Text);
+    if (pixels == NULL)
+    {
+        LSH_FATAL("Failed to allocate memory for glyph atlas");
+        return;
+    }
+
+    // Second pass, copy the rendered bitmaps and store the character metrics
+    for (unsigned char c = 0; c < 128; c++)
+    {
+        if (glyphOffsets[c].x < 0 || FT_Load_Char(s_Face, c, FT_LOAD_RENDER))
+            continue;
+
+        FT_GlyphSlot glyph = s_Face->glyph;
+        LSHIVec2 offset = glyphOffsets[c];
+
+        for (unsigned int row = 0; row < glyph->bitmap.rows; row++)
+        {
+            memcpy(pixels + (size_t)(offset.y + row) * LSH_TEXT_ATLAS_WIDTH + offset.x,
+                glyph->bitmap.buffer + (size_t)row * glyph->bitmap.pitch,
+                glyph->bitmap.width);
+        }
+
+        // now store character for later use
+        TextCharacter character = {
+            (LSHIVec2) {
+                (int)(glyph->bitmap.width), (int)(glyph->bitmap.rows)
+            },
+            (LSHIVec2) {
+                glyph->bitmap_left, glyph->bitmap_top
+            },
+            glyph->advance.x,
+            (LSHVec4) {
+                (float)offset.x / LSH_TEXT_ATLAS_WIDTH,
+                (float)offset.y / atlasHeight,
+                (float)(offset.x + glyph->bitmap.width) / LSH_TEXT_ATLAS_WIDTH,
+                (float)(offset.y + glyph->bitmap.rows) / atlasHeight
+            }
+        };
+
+        s_Characters[(int)c] = character;
+    }
+
+    SetPixelUnpackAlignment(1); // disable byte-alignment restriction
+
+    glGenTextures(1, &s_AtlasRendererID);
+    BindTexture2D(0, s_AtlasRendererID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, LSH_TEXT_ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+
+    // set texture options
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    SetPixelUnpackAlignment(4); // Undo byte alignment
+
+    LSH_FREE(pixels);
+
+    LSH_TRACE("Glyph atlas built: %dx%d", LSH_TEXT_ATLAS_WIDTH, atlasHeight);
+}
+
+void InitText(uint32_t quadVBO, uint32_t quadIBO)
 {
     if (FT_Init_FreeType(&s_FT))
     {
@@ -42,67 +174,44 @@ void InitText()
         FT_Set_Pixel_Sizes(s_Face, 0, (FT_UInt)s_TextSizeBase);
        // FT_Set_Char_Size(s_Face, 0, 100, 1280, 1280);
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+        LSH_PROFILE_BEGIN("BuildGlyphAtlas");
+        BuildGlyphAtlas();
+        LSH_PROFILE_END();
+    }
 
-        for (unsigned char c = 0; c < 128; c++)
-        {
-            // load character glyph 
-        if (FT_Load_Char(s_Face, c, FT_LOAD_RENDER))
-            {
-                LSH_ERROR("FREETYTPE: Failed to load Glyph");
-                continue;
-            }
+    glGenVertexArrays(1, &s_TextVAO);
+    BindVertexArray(s_TextVAO);
 
-            // generate texture
-            uint32_t texture;
-            glCreateTextures(GL_TEXTURE_2D, 1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                s_Face->glyph->bitmap.width,
-                s_Face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                s_Face->glyph->bitmap.buffer
-            );
-
-            // set texture options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            // now store character for later use
-            TextCharacter character = {
-                (LSHIVec2) {
-                            (int)(s_Face->glyph->bitmap.width), (int)(s_Face->glyph->bitmap.rows)
-                    },
-                    (LSHIVec2) {
-                    s_Face->glyph->bitmap_left, s_Face->glyph->bitmap_top
-                    },
-                    s_Face->glyph->advance.x,
-                    texture
-            };
-
-            s_Characters[(int)c] = character;
-        }
+    BindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIBO);
+
+    // Per-vertex unit quad
+    BindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    // Per-glyph data
+    SetGlyphAttributes(0);
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // Undo byte alignment
+    for (uint32_t i = 2; i <= 5; i++)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
     }
 
+    BindVertexArray(0);
+
 	LSH_TRACE("Initialized text");
 }
 
-void RenderTextLine(const char* text, uint32_t length, const LSHVec2* position, const LSHVec2* bboxDim, float scale, const LSHVec4* color)
+void BeginTextBatch()
 {
-    UploadUniform4f("uTextColor", color);
-
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
-    glActiveTexture(GL_TEXTURE0);
+    s_GlyphCount = 0;
+}
 
+void RenderTextLine(const char* text, uint32_t length, const LSHVec3* position, const LSHVec2* bboxDim, float scale, const LSHVec4* color)
+{
     float x = position->x + (bboxDim->x * 0.25f);
 
     scale *= 0.01f * s_TextSizeAdj;
@@ -110,40 +219,84 @@ void RenderTextLine(const char* text, uint32_t length, const LSHVec2* position,
     // iterate through all characters
     for (uint32_t i = 0; i < length; i++)
     {
-        TextCharacter ch = s_Characters[(int)(text[i])];
+        TextCharacter ch = s_Characters[(int)(text[i]) & 127];
 
         float xpos = x + ch.Bearing.x * scale;
         float ypos = (position->y + (ch.Size.y - ch.Bearing.y) * scale) + (s_TextSizeBase * scale);
 
         float w = ch.Size.x * scale;
-        float h = -(ch.Size.y * scale);
-        // update VBO for each character
-        float vertices[] = {
-           // Coords             // TexCoords
-            xpos + w, ypos,       1.0f, 1.0f, 
-            xpos + w, ypos + h,   1.0f, 0.0f, 
-            xpos,     ypos + h,   0.0f, 0.0f, 
-            xpos,     ypos,       0.0f, 1.0f
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.RendererID);
-
-        // update content of VBO memory
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        float h = ch.Size.y * scale;
 
-        // render quad
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-
         x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+
+        if (ch.Size.x == 0 || ch.Size.y == 0)
+            continue;
+
+        if (s_GlyphCount >= LSH_TEXT_BATCH_MAX_GLYPHS)
+            FlushTextBatch();
+
+        // Quad grows down from the glyph top, atlas rows are stored top to bottom
+        GlyphInstance* glyph = &s_Glyphs[s_GlyphCount++];
+        glyph->Position = (LSHVec3){ xpos, ypos - h, position->z };
+        glyph->Size = (LSHVec2){ w, h };
+        glyph->AtlasUV = ch.AtlasUV;
+        glyph->Color = *color;
     }
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // Undo byte alignment
+void FlushTextBatch()
+{
+    if (s_GlyphCount == 0)
+        return;
+
+    SetActiveShader(UIShaderType_Text);
+    BindTexture2D(0, s_AtlasRendererID);
+
+    uint32_t size = s_GlyphCount * (uint32_t)sizeof(GlyphInstance);
+    StreamAllocation allocation = AllocateStreamBuffer(size, (uint32_t)sizeof(GlyphInstance));
+    if (allocation.Data == NULL)
+    {
+        LSH_ERROR("Failed to allocate %u glyphs from the stream buffer", s_GlyphCount);
+        s_GlyphCount = 0;
+        return;
+    }
+
+    memcpy(allocation.Data, s_Glyphs, size);
+    CommitStreamBuffer(&allocation);
+    CountGlyphs(s_GlyphCount);
+
+    BindVertexArray(s_TextVAO);
+    if (IsBaseInstanceSupported())
+    {
+        DrawQuadsInstanced(s_GlyphCount, allocation.Offset / (uint32_t)sizeof(GlyphInstance));
+    }
+    else
+    {
+        SetGlyphAttributes(allocation.Offset);
+        DrawQuadsInstanced(s_GlyphCount, 0);
+    }
+
+    s_GlyphCount = 0;
+}
+
+uint32_t GetQueuedGlyphCount()
+{
+    return s_GlyphCount;
+}
+
+void EndTextBatch()
+{
+    LSH_PROFILE_BEGIN(__func__);
+    FlushTextBatch();
+    LSH_PROFILE_END();
 }
 
 void ShutdownText()
 {
+    glDeleteVertexArrays(1, &s_TextVAO);
+    glDeleteTextures(1, &s_AtlasRendererID);
+
     FT_Done_Face(s_Face);
     FT_Done_FreeType(s_FT);
 
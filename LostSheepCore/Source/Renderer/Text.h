@@ -4,16 +4,38 @@
 
 #include <stdint.h>
 
+#define LSH_TEXT_ATLAS_WIDTH 1024
+#define LSH_TEXT_BATCH_MAX_GLYPHS 8192
+
 typedef struct TextCharacter {
     LSHIVec2   Size;       // Size of glyph
     LSHIVec2   Bearing;    // Offset from baseline to left/top of glyph
     uint32_t Advance;    // Offset to advance to next glyph
-    uint32_t RendererID;  // ID handle of the glyph texture
+    LSHVec4 AtlasUV;     // x,y: top-left; z,w: bottom-right in the glyph atlas
 } TextCharacter;
 
+// Per-glyph instance data, layout must match the instance attributes of Text.glsl
+typedef struct GlyphInstance
+{
+    LSHVec3 Position;
+    LSHVec2 Size;
+    LSHVec4 AtlasUV;
+    LSHVec4 Color;
+} GlyphInstance;
+
+// Uses the renderer's unit quad buffers for the per-vertex attributes
+void InitText(uint32_t quadVBO, uint32_t quadIBO);
+
+void BeginTextBatch();
+
+// Appends the glyph quads of the line to the text batch, drawn on FlushTextBatch
+void RenderTextLine(const char* text, uint32_t length, const LSHVec3* position, const LSHVec2* bboxDim, float scale, const LSHVec4* color);
+
+void FlushTextBatch();
 
-void InitText();
+// Glyphs appended since the last flush
+uint32_t GetQueuedGlyphCount();
 
-void RenderTextLine(const char* text, uint32_t length, const LSHVec2* position, const LSHVec2* bboxDim, float scale, const LSHVec4* color);
+void EndTextBatch();
 
-void ShutdownText();
\ No newline at end of file
+void ShutdownText();
@@ -1,6 +1,13 @@
+#define LSH_LOG_CATEGORY LogCategory_Assets
+
 #include "Texture.h"
 
+#include "Core/JobSystem.h"
 #include "Core/Log.h"
+#include "Core/Memory.h"
+#include "Core/Profiler.h"
+
+#include "Renderer/RenderState.h"
 
 #include "glad/glad.h"
 
@@ -94,56 +101,103 @@ static uint32_t GetTextureIDByName(const char* name)
 	return -1;
 }
 
-void InitTexture()
+typedef struct DecodedImage
 {
-	for (uint32_t i = 0; i < s_TexturePathCount; i++)
+	const char* Path;
+	const char* Name;
+	stbi_uc* Data;
+	int Width;
+	int Height;
+	int Channels;
+} DecodedImage;
+
+// CPU only, safe to run on any thread
+static void DecodeImage(DecodedImage* image)
+{
+	LSH_PROFILE_BEGIN(__func__);
+
+	image->Data = stbi_load(image->Path, &image->Width, &image->Height, &image->Channels, 0);
+	image->Name = strrchr(image->Path, '/');
+
+	if (!image->Data)
 	{
-		LoadTexture(s_TexturePaths[i]);
+		image->Data = stbi_load("Content/Texture/UVChecker.png", &image->Width, &image->Height, &image->Channels, 0);
+		image->Name = "DefaultTexture";
 	}
+
+	LSH_PROFILE_END();
 }
 
-uint32_t LoadTexture(const char* path)
+static void DecodeImages(uint32_t start, uint32_t end, void* userData)
 {
-	int width, height, channels;
-	const char* name;
-	stbi_uc* data = NULL;
-
-	{
-		data = stbi_load(path, &width, &height, &channels, 0);
-		name = strrchr(path, '/');
-	}
-	if (!data)
-	{
-		data = stbi_load("Content/Texture/UVChecker.png", &width, &height, &channels, 0);
-		name = "DefaultTexture";
-	}
+	DecodedImage* images = (DecodedImage*)userData;
+	for (uint32_t i = start; i < end; i++)
+		DecodeImage(&images[i]);
+}
 
+// Needs the context, frees the decoded pixels
+static uint32_t UploadImage(DecodedImage* image)
+{
 	TextureSpecification spec;
-	spec.Width = width;
-	spec.Height = height;
+	spec.Width = image->Width;
+	spec.Height = image->Height;
 
-	if (channels == 4)
+	if (image->Channels == 4)
 	{
 		spec.Format = ImageFormat_RGBA8;
 	}
-	else if (channels == 3)
+	else if (image->Channels == 3)
 	{
 		spec.Format = ImageFormat_RGB8;
 	}
 
-	TextureInfo* texture = CreateTexture(&spec, data);
-	texture->Name = _strdup(name);
-	texture->Path = _strdup(path);
-	stbi_image_free(data);
+	TextureInfo* texture = CreateTexture(&spec, image->Data);
+	texture->Name = LSH_STRDUP(image->Name, MemoryTag_Assets);
+	texture->Path = LSH_STRDUP(image->Path, MemoryTag_Assets);
+	stbi_image_free(image->Data);
+	image->Data = NULL;
 
 	s_Textures[s_TextureCount] = texture;
 	s_TextureCount++;
 
-	LSH_TRACE("Imported Texture2D: %s", path);
+	LSH_TRACE("Imported Texture2D: %s", image->Path);
 
 	return texture->RendererID;
 }
 
+void InitTexture()
+{
+	LSH_PROFILE_BEGIN(__func__);
+
+	// Images are decoded in parallel, uploads stay on the context thread in load order
+	DecodedImage images[sizeof(s_TexturePaths) / sizeof(s_TexturePaths[0])];
+	for (uint32_t i = 0; i < s_TexturePathCount; i++)
+		images[i].Path = s_TexturePaths[i];
+
+	ParallelFor(s_TexturePathCount, 1, DecodeImages, images);
+
+	LSH_PROFILE_BEGIN("UploadImages");
+	for (uint32_t i = 0; i < s_TexturePathCount; i++)
+		UploadImage(&images[i]);
+	LSH_PROFILE_END();
+
+	LSH_PROFILE_END();
+}
+
+uint32_t LoadTexture(const char* path)
+{
+	DecodedImage image;
+	image.Path = path;
+	LSH_PROFILE_BEGIN(__func__);
+
+	DecodeImage(&image);
+	uint32_t rendererID = UploadImage(&image);
+
+	LSH_PROFILE_END();
+
+	return rendererID;
+}
+
 uint32_t GetTextureRendererID(TextureName textureName)
 {
 	return s_Textures[textureName]->RendererID;
@@ -151,13 +205,13 @@ uint32_t GetTextureRendererID(TextureName textureName)
 
 TextureInfo* CreateTexture(const TextureSpecification* spec, const void* data)
 {
-	TextureInfo* texture = (TextureInfo*)malloc(sizeof(TextureInfo));
+	TextureInfo* texture = (TextureInfo*)LSH_MALLOC(sizeof(TextureInfo), MemoryTag_Assets);
 	uint32_t internalFormat = ToOpenGLTexInternalFormat(spec->Format);
 	uint32_t dataFormat = ToOpenGLTexDataFormat(spec->Format);
 	uint32_t rendererID = 0;
 
 	glCreateTextures(GL_TEXTURE_2D, 1, &rendererID);
-	glBindTexture(GL_TEXTURE_2D, rendererID);
+	BindTexture2D(0, rendererID);
 	glTextureStorage2D(rendererID, 1, internalFormat, spec->Width, spec->Height);
 
 	glTextureParameteri(rendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -178,13 +232,12 @@ TextureInfo* CreateTexture(const TextureSpecification* spec, const void* data)
 
 void BindActiveTexture(TextureName textureName, uint32_t slot)
 {
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, GetTextureRendererID(textureName));
+	BindTexture2D(slot, GetTextureRendererID(textureName));
 }
 
 void UnbindTexture(const char* name)
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
+	BindTexture2D(0, 0);
 }
 
 void ShutdownTexture()
@@ -193,10 +246,10 @@ void ShutdownTexture()
 	{
 		glDeleteTextures(1, &(s_Textures[i]->RendererID));
 
-		free(s_Textures[i]->Name);
-		free(s_Textures[i]->Path);
+		LSH_FREE(s_Textures[i]->Name);
+		LSH_FREE(s_Textures[i]->Path);
 
-		free(s_Textures[i]);
+		LSH_FREE(s_Textures[i]);
 	}
 
 	LSH_TRACE("Shutdown texture");
@@ -0,0 +1,94 @@
+#define LSH_LOG_CATEGORY LogCategory_Renderer
+
+#include "TimeGraph.h"
+
+#include "Core/FrameTimings.h"
+#include "Core/Profiler.h"
+
+#include "Renderer/QuadBatch.h"
+
+// Frame budget drawn as a reference line, the scale never goes below two of them
+static const float s_BudgetMilliseconds = 1000.0f / 60.0f;
+
+static const LSHVec4 s_ZoneColors[FrameTimingZone_Count] = {
+	{ 0.45f, 0.45f, 0.45f, 1.0f }, // Rest of the frame, input and events
+	{ 0.30f, 0.60f, 0.95f, 1.0f }, // Layout
+	{ 0.40f, 0.80f, 0.45f, 1.0f }, // Submit
+	{ 0.95f, 0.65f, 0.25f, 1.0f }  // Swap
+};
+
+static const LSHVec4 s_SpikeColor = { 0.95f, 0.25f, 0.25f, 1.0f };
+static const LSHVec4 s_BudgetColor = { 1.0f, 1.0f, 1.0f, 0.35f };
+static const LSHVec4 s_MedianColor = { 0.30f, 0.60f, 0.95f, 0.6f };
+
+static void SubmitGraphQuad(float x, float y, float width, float height, float z, const LSHVec4* color)
+{
+	QuadInstance instance = {
+		.Position = { x, y, z },
+		.Size = { width, height },
+		.Color = *color,
+		.CornerRadius = 0.0f,
+		.BorderThickness = 0.0f,
+		.TextureSlot = -1
+	};
+
+	SubmitQuad(&instance);
+}
+
+void RenderTimeGraph(float x, float y, float width, float height, float z, const LSHVec4* backgroundColor)
+{
+	LSH_PROFILE_BEGIN(__func__);
+
+	SubmitGraphQuad(x, y, width, height, z, backgroundColor);
+
+	uint32_t count = GetFrameTimingCount();
+	const FrameTimingPercentiles* frame = GetFrameTimingPercentiles(FrameTimingZone_Frame);
+
+	// Outliers past the scale are clipped, the spike marker still shows them
+	float scale = frame->P99 * 1.5f;
+	if (scale < s_BudgetMilliseconds * 2.0f)
+		scale = s_BudgetMilliseconds * 2.0f;
+	float pixelsPerMillisecond = height / scale;
+	float bottom = y + height;
+
+	float columnWidth = width / (float)LSH_FRAME_TIMING_SAMPLES;
+	float barWidth = columnWidth >= 3.0f ? columnWidth - 1.0f : columnWidth;
+	float spikeThreshold = frame->P50 * LSH_TIME_GRAPH_SPIKE_FACTOR;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const FrameTimingSample* sample = GetFrameTimingSample(i);
+		float columnX = x + width - (float)(count - i) * columnWidth;
+
+		// Zones stack from the bottom, what they don't cover is the rest of the frame
+		float barTop = bottom;
+		float zoneTotal = 0.0f;
+		for (int zone = FrameTimingZone_Layout; zone < FrameTimingZone_Count; zone++)
+		{
+			float zoneHeight = sample->Zones[zone] * pixelsPerMillisecond;
+			if (barTop - zoneHeight < y)
+				zoneHeight = barTop - y;
+			if (zoneHeight <= 0.0f)
+				continue;
+
+			barTop -= zoneHeight;
+			zoneTotal += sample->Zones[zone];
+			SubmitGraphQuad(columnX, barTop, barWidth, zoneHeight, z + 1.0f, &s_ZoneColors[zone]);
+		}
+
+		float restHeight = (sample->Zones[FrameTimingZone_Frame] - zoneTotal) * pixelsPerMillisecond;
+		if (barTop - restHeight < y)
+			restHeight = barTop - y;
+		if (restHeight > 0.0f)
+			SubmitGraphQuad(columnX, barTop - restHeight, barWidth, restHeight, z + 1.0f, &s_ZoneColors[FrameTimingZone_Frame]);
+
+		if (count > 1 && sample->Zones[FrameTimingZone_Frame] > spikeThreshold)
+			SubmitGraphQuad(columnX, y, barWidth, 4.0f, z + 2.0f, &s_SpikeColor);
+	}
+
+	SubmitGraphQuad(x, bottom - s_BudgetMilliseconds * pixelsPerMillisecond, width, 1.0f, z + 2.0f, &s_BudgetColor);
+	if (count > 0)
+		SubmitGraphQuad(x, bottom - frame->P50 * pixelsPerMillisecond, width, 1.0f, z + 2.0f, &s_MedianColor);
+
+	LSH_PROFILE_END();
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Math/Types.h"
+
+// Depth slots taken by one graph: background, bars and markers
+#define LSH_TIME_GRAPH_LAYERS 3
+
+// Frames slower than this many times the median are marked as spikes
+#define LSH_TIME_GRAPH_SPIKE_FACTOR 2.0f
+
+// Stacked bars of the frame timing ring, newest on the right, all queued into the quad batch
+void RenderTimeGraph(float x, float y, float width, float height, float z, const LSHVec4* backgroundColor);
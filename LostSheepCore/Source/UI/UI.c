@@ -1,13 +1,20 @@
+#define LSH_LOG_CATEGORY LogCategory_UI
+
 #include "UI.h"
 
 #include "Core/Application.h"
+#include "Core/FrameArena.h"
+#include "Core/FrameTimings.h"
 #include "Core/Window.h"
 #include "Core/Log.h"
+#include "Core/Memory.h"
+#include "Core/Profiler.h"
 #include "Core/Input.h"
 
 #include "Event/Event.h"
 
 #include "Renderer/Renderer.h"
+#include "Renderer/RendererStats.h"
 #include "Renderer/Shader.h"
 #include "Renderer/Texture.h"
 
@@ -21,6 +28,10 @@
 #include <string.h>
 
 static int s_DebugLayout = 0;
+static int s_StatsOverlay = 0;
+
+static const char* s_RendererStatsCSVPath = "Logs/RendererStats.csv";
+static const char* s_RendererStatsJSONPath = "Logs/RendererStats.json";
 static float s_DeltaTime = 16.66f;
 
 static float s_DoubleClickThreshold = 510.0f;
@@ -56,6 +67,12 @@ static int s_LeftClickDown = 0;
 static int s_CurrentEventIndex = 0;
 static MouseEventStackElement s_MouseEventQueue[32];
 
+// Commands of the last layout, submitted by RenderUI
+static Clay_RenderCommandArray s_RenderCommands;
+static uint64_t s_RenderCommandsHash = 0;
+
+static void* s_ClayMemory = NULL;
+
 static const char* ClayCommandTypeToString(Clay_RenderCommandType type) {
 	switch (type) {
 	case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: return "RECTANGLE";
@@ -110,8 +127,7 @@ static int SetWindowPosition()
 	if(s_ChangeWindowPosition)
 	{
 		LSHIVec2 windowPos = { 0, 0 };
-		GLFWwindow* window = GetNativeWindow();
-		glfwGetWindowPos(window, &windowPos.x, &windowPos.y);
+		GetPositionWindow(&windowPos.x, &windowPos.y);
 
 		if (!s_LockedDelta)
 		{
@@ -120,7 +136,7 @@ static int SetWindowPosition()
 			s_LockedDelta = 1;
 		}
 
-		glfwSetWindowPos(window, (int)(windowPos.x + s_xPos - s_MousePos.x), (int)(windowPos.y + s_yPos - s_MousePos.y));
+		SetPositionWindow((int)(windowPos.x + s_xPos - s_MousePos.x), (int)(windowPos.y + s_yPos - s_MousePos.y));
 		return 1;
 	}
 
@@ -198,6 +214,60 @@ static inline Clay_Dimensions MeasureText(Clay_StringSlice text, Clay_TextElemen
 	};
 }
 
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	// FNV-1a
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+// Only hashes what ends up on screen, text is hashed by content since its chars may be reused
+static uint64_t HashRenderCommands(Clay_RenderCommandArray commands)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	hash = HashBytes(hash, &commands.length, sizeof(commands.length));
+
+	for (int i = 0; i < commands.length; i++)
+	{
+		const Clay_RenderCommand* cmd = &commands.internalArray[i];
+		hash = HashBytes(hash, &cmd->commandType, sizeof(cmd->commandType));
+		hash = HashBytes(hash, &cmd->boundingBox, sizeof(cmd->boundingBox));
+
+		switch (cmd->commandType)
+		{
+		case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+			hash = HashBytes(hash, &cmd->renderData.rectangle, sizeof(cmd->renderData.rectangle));
+			break;
+		case CLAY_RENDER_COMMAND_TYPE_BORDER:
+			hash = HashBytes(hash, &cmd->renderData.border, sizeof(cmd->renderData.border));
+			break;
+		case CLAY_RENDER_COMMAND_TYPE_TEXT:
+		{
+			const Clay_TextRenderData* text = &cmd->renderData.text;
+			hash = HashBytes(hash, text->stringContents.chars, (size_t)text->stringContents.length);
+			hash = HashBytes(hash, &text->textColor, sizeof(text->textColor));
+			hash = HashBytes(hash, &text->fontSize, sizeof(text->fontSize));
+			break;
+		}
+		case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+			hash = HashBytes(hash, &cmd->renderData.image, sizeof(cmd->renderData.image));
+			break;
+		case CLAY_RENDER_COMMAND_TYPE_CUSTOM:
+			hash = HashBytes(hash, &cmd->renderData.custom, sizeof(cmd->renderData.custom));
+			break;
+		default:
+			break;
+		}
+	}
+
+	return hash;
+}
+
 static void UpdatePointerState()
 {
 	s_xPos = GetMouseX();
@@ -419,18 +489,76 @@ static void RenderHomeTabUI(const char* tabName)
 	}
 }
 
+static const CustomElementType s_TimeGraphElement = CustomElementType_TimeGraph;
+
+// Labels come from FormatFrameArena, which returns NULL when the arena is out of memory
+static void RenderTimeGraphTextUI(const char* text, Clay_Color color)
+{
+	CLAY_TEXT(ClayStringFromC(text != NULL ? text : ""),
+		CLAY_TEXT_CONFIG({
+			.fontSize = 16,
+			.textColor = color
+			})
+	);
+}
+
 static void RenderTimeGraphTabUI(const char* tabName)
 {
+	// The graph changes every frame without the layout changing
+	RequestRedrawRenderer();
+
+	const FrameTimingPercentiles* frame = GetFrameTimingPercentiles(FrameTimingZone_Frame);
+	const FrameTimingPercentiles* layout = GetFrameTimingPercentiles(FrameTimingZone_Layout);
+	const FrameTimingPercentiles* submit = GetFrameTimingPercentiles(FrameTimingZone_Submit);
+	const FrameTimingPercentiles* swap = GetFrameTimingPercentiles(FrameTimingZone_Swap);
+
+	// Text has to live until the frame is rendered
+	const char* frameText = FormatFrameArena("Frame  p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms",
+		frame->P50, frame->P95, frame->P99, frame->Max);
+	const char* layoutText = FormatFrameArena("Layout p50 %.2f ms", layout->P50);
+	const char* submitText = FormatFrameArena("Submit p50 %.2f ms", submit->P50);
+	const char* swapText = FormatFrameArena("Swap p50 %.2f ms", swap->P50);
+
 	CLAY({
 	.id = CLAY_SID(ClayStringFromC(tabName)),
 	.floating = {.attachTo = CLAY_ATTACH_TO_PARENT },
-	.backgroundColor = (Clay_Color){0.69f, 0.87f, 0.85f, Clay_Hovered() ? 1.0f : 0.5f},
+	.backgroundColor = (Clay_Color){0.15f, 0.15f, 0.15f, 1.0f},
 	.layout = {
-		.layoutDirection = CLAY_LEFT_TO_RIGHT,
+		.layoutDirection = CLAY_TOP_TO_BOTTOM,
 		.sizing = {CLAY_SIZING_GROW(1.0f), CLAY_SIZING_GROW(1.0f)},
+		.padding = CLAY_PADDING_ALL(8),
+		.childGap = 8
 	}
 		})
 	{
+		RenderTimeGraphTextUI(frameText, (Clay_Color){1.0f, 1.0f, 1.0f, 1.0f});
+
+		CLAY({
+		.id = CLAY_ID("TimeGraphLegend"),
+		.layout = {
+			.layoutDirection = CLAY_LEFT_TO_RIGHT,
+			.sizing = {CLAY_SIZING_GROW(1.0f), CLAY_SIZING_FIT(1.0f)},
+			.childGap = 24
+		}
+			})
+		{
+			// Colors match the zones in TimeGraph.c
+			RenderTimeGraphTextUI(layoutText, (Clay_Color){0.30f, 0.60f, 0.95f, 1.0f});
+			RenderTimeGraphTextUI(submitText, (Clay_Color){0.40f, 0.80f, 0.45f, 1.0f});
+			RenderTimeGraphTextUI(swapText, (Clay_Color){0.95f, 0.65f, 0.25f, 1.0f});
+			RenderTimeGraphTextUI("Spike", (Clay_Color){0.95f, 0.25f, 0.25f, 1.0f});
+		}
+
+		CLAY({
+		.id = CLAY_ID("TimeGraphPlot"),
+		.backgroundColor = (Clay_Color){0.08f, 0.08f, 0.08f, 1.0f},
+		.custom = {.customData = (void*)&s_TimeGraphElement },
+		.layout = {
+			.sizing = {CLAY_SIZING_GROW(1.0f), CLAY_SIZING_GROW(1.0f)},
+		}
+			})
+		{
+		}
 	}
 }
 
@@ -598,16 +726,16 @@ void InitTabBarContent()
 {
 	s_TabBarContent.Count = 0;
 	s_TabBarContent.Capacity = 4;
-	s_TabBarContent.TabBarElements = malloc(sizeof(TabBarElement*) * s_TabBarContent.Capacity);
+	s_TabBarContent.TabBarElements = LSH_MALLOC(sizeof(TabBarElement*) * s_TabBarContent.Capacity, MemoryTag_UI);
 }
 
 void AddTabBarElement(const char* tabName, TabUIfn UIfn)
 {
-	if (s_TabBarContent.Count > s_TabBarContent.Capacity)
+	if (s_TabBarContent.Count >= s_TabBarContent.Capacity)
 	{
 		int growCapacity = 4;
 		s_TabBarContent.Capacity += growCapacity;
-		TabBarElement** newTabBarElements = realloc(s_TabBarContent.TabBarElements, sizeof(TabBarElement) * s_TabBarContent.Capacity);
+		TabBarElement** newTabBarElements = LSH_REALLOC(s_TabBarContent.TabBarElements, sizeof(TabBarElement*) * s_TabBarContent.Capacity, MemoryTag_UI);
 
 		if (newTabBarElements == NULL)
 		{
@@ -620,7 +748,7 @@ void AddTabBarElement(const char* tabName, TabUIfn UIfn)
 		s_TabBarContent.TabBarElements = newTabBarElements;
 	}
 
-	TabBarElement* newElement = (TabBarElement*)malloc(sizeof(TabBarElement));
+	TabBarElement* newElement = (TabBarElement*)LSH_MALLOC(sizeof(TabBarElement), MemoryTag_UI);
 
 	if (newElement == NULL)
 	{
@@ -628,16 +756,12 @@ void AddTabBarElement(const char* tabName, TabUIfn UIfn)
 		return;
 	}
 
-#ifdef LSH_PLATFORM_WINDOWS
-		newElement->TabName = _strdup(tabName);
-#else
-		newElement->TabName = strdup(tabName);
-#endif
+	newElement->TabName = LSH_STRDUP(tabName, MemoryTag_UI);
 
 	if (!newElement->TabName)
 	{
 		LSH_FATAL("Failed to duplicate tab name: %s", tabName);
-		free(newElement);
+		LSH_FREE(newElement);
 		return;
 	}
 
@@ -649,10 +773,10 @@ void AddTabBarElement(const char* tabName, TabUIfn UIfn)
 void CleanTabBarContent()
 {
 	for (int i = 0; i < s_TabBarContent.Count; i++) {
-		free(s_TabBarContent.TabBarElements[i]->TabName);
-		free(s_TabBarContent.TabBarElements[i]);
+		LSH_FREE(s_TabBarContent.TabBarElements[i]->TabName);
+		LSH_FREE(s_TabBarContent.TabBarElements[i]);
 	}
-	free(s_TabBarContent.TabBarElements);
+	LSH_FREE(s_TabBarContent.TabBarElements);
 	s_TabBarContent.TabBarElements = NULL;
 	s_TabBarContent.Count = 0;
 	s_TabBarContent.Capacity = 0;
@@ -665,16 +789,14 @@ void InitUI()
 	WindowData* data = (WindowData*)glfwGetWindowUserPointer(window);
 
 	uint64_t totalMemorySize = Clay_MinMemorySize();
-	Clay_Arena arena = Clay_CreateArenaWithCapacityAndMemory(totalMemorySize, malloc(totalMemorySize));
+	s_ClayMemory = LSH_MALLOC(totalMemorySize, MemoryTag_UI);
+	Clay_Arena arena = Clay_CreateArenaWithCapacityAndMemory(totalMemorySize, s_ClayMemory);
 	Clay_Initialize(arena, (Clay_Dimensions) { (float)data->Width, (float)data->Height }, (Clay_ErrorHandler) { HandleClayErrors });
 	Clay_SetMeasureTextFunction(MeasureText, 0);
 
 	Clay_SetLayoutDimensions((Clay_Dimensions) { (float)data->Width, (float)data->Height });
 
-	double mouseX, mouseY;
-	int isMouseDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
-	glfwGetCursorPos(window, &mouseX, &mouseY);
-	Clay_SetPointerState((Clay_Vector2) { (float)mouseX, (float)mouseY }, isMouseDown);
+	Clay_SetPointerState((Clay_Vector2) { GetMouseX(), GetMouseY() }, IsMouseButtonPressed(LSH_MOUSE_BUTTON_LEFT));
 
 	Clay_UpdateScrollContainers(true, (Clay_Vector2) { 0.0f, 0.0f }, s_DeltaTime);
 
@@ -684,10 +806,17 @@ void InitUI()
 	InitTabBarContent();
 	AddTabBarElement("Home", RenderHomeTabUI);
 	AddTabBarElement("TimeGraph", RenderTimeGraphTabUI);
+
+	SubscribeEvent(EventTypeWindowResize, OnResizeWindowUI, EventPriorityUI);
+	SubscribeEvent(EventTypeMouseScrolled, OnMouseScrollUI, EventPriorityUI);
+	SubscribeEvent(EventTypeKeyPressed, OnKeyPressUI, EventPriorityUI);
+	SubscribeEvent(EventTypeMouseButtonPressed, OnMouseClickedUI, EventPriorityUI);
 }
 
-void OnUpdateUI(float deltaTime)
+int OnUpdateUI(float deltaTime)
 {
+	LSH_PROFILE_BEGIN(__func__);
+
 	// Reset mouse event queue;
 	s_CurrentEventIndex = 0;
 
@@ -697,23 +826,74 @@ void OnUpdateUI(float deltaTime)
 	ListenForMouseButtonDown();
 	SetWindowPosition();
 
+	// Input of this frame is applied before the layout so hovers and clicks show up in the same frame
+	Clay_SetLayoutDimensions((Clay_Dimensions) { (float)(GetWindowData()->Width), (float)(GetWindowData()->Height) });
+	UpdatePointerState();
+
+	LSH_PROFILE_BEGIN("BuildUI");
 	Clay_BeginLayout();
 	BuildUI();
-	Clay_RenderCommandArray commands = Clay_EndLayout();
+	LSH_PROFILE_END();
 
-	ProcessRenderUICommands(commands);
+	LSH_PROFILE_BEGIN("Clay_EndLayout");
+	s_RenderCommands = Clay_EndLayout();
+	LSH_PROFILE_END();
 
-	Clay_SetLayoutDimensions((Clay_Dimensions) { (float)(GetWindowData()->Width), (float)(GetWindowData()->Height) });
+	uint64_t hash = HashRenderCommands(s_RenderCommands);
+	int changed = hash != s_RenderCommandsHash;
+	s_RenderCommandsHash = hash;
 
-	UpdatePointerState();
+	LSH_PROFILE_END();
+
+	return changed;
 }
 
-void OnEventUI(Event* event)
+// Counters of the previous rendered frame, this one isn't submitted yet
+static void RenderStatsOverlayUI()
 {
-	DispatchEvent(EventTypeWindowResize, event, OnResizeWindowUI);
-	DispatchEvent(EventTypeMouseScrolled, event, OnMouseScrollUI);
-	DispatchEvent(EventTypeKeyPressed, event, OnKeyPressUI);
-	DispatchEvent(EventTypeMouseButtonPressed, event, OnMouseClickedUI);
+	// Keeps the numbers current while the overlay is shown
+	RequestRedrawRenderer();
+
+	const RendererStats* stats = GetRendererStats();
+
+	const char* lines[] = {
+		FormatFrameArena("Layout %.2f ms  Submit %.2f ms", stats->LayoutMilliseconds, stats->SubmitMilliseconds),
+		FormatFrameArena("Commands %u  rect %u  border %u  text %u  image %u  custom %u", stats->TotalCommands,
+			stats->Commands[RenderCommandType_Rectangle], stats->Commands[RenderCommandType_Border], stats->Commands[RenderCommandType_Text],
+			stats->Commands[RenderCommandType_Image], stats->Commands[RenderCommandType_Custom]),
+		FormatFrameArena("Draws %u  Instances %u  Programs %u  Textures %u",
+			stats->State.DrawCalls, stats->State.Instances, stats->State.ProgramBinds, stats->State.TextureBinds),
+		FormatFrameArena("Quads %u  Glyphs %u  Uploaded %.1f KB", stats->Quads, stats->Glyphs, (double)stats->State.BytesUploaded / 1024.0)
+	};
+
+	CLAY({
+		.id = CLAY_ID("StatsOverlay"),
+		.floating = {
+			.attachTo = CLAY_ATTACH_TO_ROOT,
+			.attachPoints = {.element = CLAY_ATTACH_POINT_RIGHT_TOP, .parent = CLAY_ATTACH_POINT_RIGHT_TOP },
+			.offset = { -12.0f, 48.0f },
+			.zIndex = 100
+		},
+		.backgroundColor = (Clay_Color){0.0f, 0.0f, 0.0f, 0.7f},
+		.layout = {
+			.layoutDirection = CLAY_TOP_TO_BOTTOM,
+			.sizing = {CLAY_SIZING_FIT(1.0f), CLAY_SIZING_FIT(1.0f)},
+			.padding = CLAY_PADDING_ALL(8),
+			.childGap = 4
+		}
+		})
+		{
+			for (uint32_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+			{
+				// NULL when the frame arena is out of memory
+				CLAY_TEXT(ClayStringFromC(lines[i] != NULL ? lines[i] : ""),
+					CLAY_TEXT_CONFIG({
+						.fontSize = 14,
+						.textColor = {1.0f, 1.0f, 1.0f, 1.0f}
+						})
+				);
+			}
+		}
 }
 
 void BuildUI()
@@ -733,16 +913,21 @@ void BuildUI()
 			RenderTitleBarUI();
 
 			RenderDockspaceUI();
+
+			if (s_StatsOverlay)
+				RenderStatsOverlayUI();
 		}
 }
 
 void RenderUI()
 {
+	ProcessRenderUICommands(s_RenderCommands);
 }
 
 void ProcessRenderUICommands(Clay_RenderCommandArray commands)
 {
 	//LSH_INFO("Processing %d render commands", commands.length);
+	LSH_PROFILE_BEGIN(__func__);
 	for (int i = 0; i < commands.length; i++)
 	{
 		Clay_RenderCommand* cmd = &commands.internalArray[i];
@@ -752,28 +937,36 @@ void ProcessRenderUICommands(Clay_RenderCommandArray commands)
 		switch (cmd->commandType)
 		{
 		case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+			CountRenderCommand(RenderCommandType_Rectangle);
 			RenderRectangle(cmd);
 			break;
 		case CLAY_RENDER_COMMAND_TYPE_BORDER:
+			CountRenderCommand(RenderCommandType_Border);
 			RenderBorder(cmd);
 			break;
 		case CLAY_RENDER_COMMAND_TYPE_TEXT:
+			CountRenderCommand(RenderCommandType_Text);
 			RenderText(cmd);
 			break;
 		case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+			CountRenderCommand(RenderCommandType_Image);
 			RenderImage(cmd);
 			break;
 		case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+			CountRenderCommand(RenderCommandType_ScissorStart);
 			StartClipping(cmd);
 			break;
 		case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+			CountRenderCommand(RenderCommandType_ScissorEnd);
 			EndClipping(cmd);
 			break;
 		case CLAY_RENDER_COMMAND_TYPE_CUSTOM:
+			CountRenderCommand(RenderCommandType_Custom);
 			RenderCustomElement(cmd);
 			break;
 		}
 	}
+	LSH_PROFILE_END();
 }
 
 int OnResizeWindowUI(Event* event)
@@ -821,6 +1014,18 @@ int OnKeyPressUI(Event* event)
 		Clay_SetDebugModeEnabled(s_DebugLayout);
 		return 1;
 	}
+	if (*((int*)event->Data) == LSH_KEY_S)
+	{
+		s_StatsOverlay = !s_StatsOverlay;
+		RequestRedrawRenderer();
+		return 1;
+	}
+	if (*((int*)event->Data) == LSH_KEY_E)
+	{
+		ExportRendererStatsCSV(s_RendererStatsCSVPath);
+		ExportRendererStatsJSON(s_RendererStatsJSONPath);
+		return 1;
+	}
 	return 0;
 }
 
@@ -841,5 +1046,13 @@ int OnMouseClickedUI(Event* event)
 
 void ShutdownUI()
 {
+	UnsubscribeEvent(EventTypeWindowResize, OnResizeWindowUI);
+	UnsubscribeEvent(EventTypeMouseScrolled, OnMouseScrollUI);
+	UnsubscribeEvent(EventTypeKeyPressed, OnKeyPressUI);
+	UnsubscribeEvent(EventTypeMouseButtonPressed, OnMouseClickedUI);
+
 	CleanTabBarContent();
+
+	LSH_FREE(s_ClayMemory);
+	s_ClayMemory = NULL;
 }
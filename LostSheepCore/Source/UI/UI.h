@@ -38,12 +38,12 @@ void CleanTabBarContent();
 // Main UI
 void InitUI();
 
-void OnUpdateUI(float deltaTime);
-
-void OnEventUI(Event* event);
+// Lays out the UI, returns 1 if the render commands differ from the last layout
+int OnUpdateUI(float deltaTime);
 
 void BuildUI();
 
+// Submits the render commands of the last layout
 void RenderUI();
 
 void ProcessRenderUICommands(Clay_RenderCommandArray commands);
@@ -64,6 +64,11 @@ project "LostSheepCore"
 			"LSH_PLATFORM_LINUX",
 			"LSH_PROJECT"
 		}
+
+		links {
+			"pthread",
+			"m"
+		}
 		
 		filter "system:macosx"
 		defines {